@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Audio.h"
 
 #include "Files.h"
+#include "LockFreeQueue.h"
 #include "Music.h"
 #include "Point.h"
 #include "Random.h"
@@ -27,6 +28,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <map>
 #include <mutex>
@@ -44,12 +47,30 @@ namespace {
 	class QueueEntry {
 	public:
 		void Add(Point position);
-		void Add(const QueueEntry &other);
+		// Get how loud this entry will be, taking the volume setting into account.
+		double Gain() const;
 		
 		Point sum;
 		double weight = 0.;
 	};
 	
+	// A sound that was requested by a thread other than the main one. These
+	// are handed off through a lock-free queue, and the main thread combines
+	// them into queue entries the next time the listener position is updated.
+	class Request {
+	public:
+		const Sound *sound = nullptr;
+		Point position;
+	};
+	
+	// A sound file that is waiting to be loaded. The sound's name is kept so
+	// that an error message can say which sound could not be loaded.
+	class SoundFile {
+	public:
+		string name;
+		string path;
+	};
+	
 	// OpenAL only allows a certain number of distinct sound sources. To work
 	// around that limitation, multiple instances of the same sound playing at
 	// the same time will be "coalesced" into a single source, and sources will
@@ -58,13 +79,20 @@ namespace {
 	public:
 		Source(const Sound *sound, unsigned source);
 		
-		void Move(const QueueEntry &entry) const;
+		void Move(const QueueEntry &entry);
 		unsigned ID() const;
 		const Sound *GetSound() const;
+		// Get how important it is to keep this source playing.
+		double Priority() const;
+		// Check if this source is still playing its sound (if not looping).
+		bool IsPlaying(chrono::steady_clock::time_point now) const;
 		
 	private:
 		const Sound *sound = nullptr;
 		unsigned source = 0;
+		double priority = 0.;
+		// When a sound that does not loop will be done playing.
+		chrono::steady_clock::time_point end;
 	};
 	
 	// Thread entry point for loading the sound files.
@@ -78,14 +106,24 @@ namespace {
 	ALCdevice *device = nullptr;
 	ALCcontext *context = nullptr;
 	bool isInitialized = false;
+	// With the null backend, no OpenAL calls are made at all. Sources are just
+	// numbers, and sounds and music "play" for as long as they would take.
+	bool isNullBackend = false;
+	unsigned nextNullSource = 0;
+	chrono::steady_clock::time_point nullMusicTime;
 	double volume = .5;
 	static const double VOLUME_SCALE = .25;
+	// Sounds that would be quieter than this are not worth giving a source to.
+	const double MIN_GAIN = .002;
 	
 	// This queue keeps track of sounds that have been requested to play. Each
 	// added sound is "deferred" until the next audio position update to make
-	// sure that all sounds from a given frame start at the same time.
+	// sure that all sounds from a given frame start at the same time. Sounds
+	// from other threads (i.e. the Engine's calculation thread) are passed
+	// along without locking, so they never have to wait for the main thread.
 	map<const Sound *, QueueEntry> queue;
-	map<const Sound *, QueueEntry> deferred;
+	const size_t MAX_DEFERRED = 4096;
+	LockFreeQueue<Request> deferred(MAX_DEFERRED);
 	thread::id mainThreadID;
 	
 	// Sound resources that have been loaded from files.
@@ -97,9 +135,14 @@ namespace {
 	vector<unsigned> endingSources;
 	unsigned maxSources = 255;
 	
-	// Queue and thread for loading sound files in the background.
-	map<string, string> loadQueue;
-	thread loadThread;
+	// Queues and threads for loading sound files in the background. Sounds that
+	// are needed right away (i.e. in the current system) are moved to the
+	// second queue, which is loaded before all the others.
+	map<const Sound *, SoundFile> loadQueue;
+	map<const Sound *, SoundFile> loadFirstQueue;
+	size_t firstTotal = 0;
+	size_t firstDone = 0;
+	vector<thread> loadThreads;
 	
 	// The current position of the "listener," i.e. the center of the screen.
 	Point listener;
@@ -112,36 +155,46 @@ namespace {
 	shared_ptr<Music> previousTrack;
 	int musicFade = 0;
 	vector<int16_t> fadeBuffer;
+	
+	// Counts of the work that has been done. Sounds may be requested from any
+	// thread, but everything else is only counted in the main thread.
+	atomic<uint64_t> requestCount(0);
+	Audio::Statistics statistics;
 }
 
 
 
-// Begin loading sounds (in a separate thread).
-void Audio::Init(const vector<string> &sources)
+// Begin loading sounds (in separate threads).
+void Audio::Init(const vector<string> &sources, bool useNullBackend)
 {
-	device = alcOpenDevice(nullptr);
-	if(!device)
-		return;
-	
-	context = alcCreateContext(device, nullptr);
-	if(!context || !alcMakeContextCurrent(context))
-		return;
+	// If there is no usable audio device, fall back to the null backend, so
+	// that the rest of the game runs the same as it would with sound.
+	isNullBackend = useNullBackend;
+	if(!isNullBackend)
+	{
+		device = alcOpenDevice(nullptr);
+		if(device)
+			context = alcCreateContext(device, nullptr);
+		isNullBackend = (!context || !alcMakeContextCurrent(context));
+	}
 	
-	// If we don't make it to this point, no audio will be played.
 	isInitialized = true;
 	mainThreadID = this_thread::get_id();
 	
-	// The listener is looking "into" the screen. This orientation vector is
-	// used to determine what sounds should be in the right or left speaker.
-	ALfloat zero[3] = {0., 0., 0.};
-	ALfloat	orientation[6] = {0., 0., -1., 0., 1., 0.};
-	
-	alListenerf(AL_GAIN, volume * VOLUME_SCALE);
-	alListenerfv(AL_POSITION, zero);
-	alListenerfv(AL_VELOCITY, zero);
-	alListenerfv(AL_ORIENTATION, orientation);
-	alDistanceModel(AL_INVERSE_DISTANCE_CLAMPED);
-	alDopplerFactor(0.);
+	if(!isNullBackend)
+	{
+		// The listener is looking "into" the screen. This orientation vector is
+		// used to determine what sounds should be in the right or left speaker.
+		ALfloat zero[3] = {0., 0., 0.};
+		ALfloat	orientation[6] = {0., 0., -1., 0., 1., 0.};
+		
+		alListenerf(AL_GAIN, volume * VOLUME_SCALE);
+		alListenerfv(AL_POSITION, zero);
+		alListenerfv(AL_VELOCITY, zero);
+		alListenerfv(AL_ORIENTATION, orientation);
+		alDistanceModel(AL_INVERSE_DISTANCE_CLAMPED);
+		alDopplerFactor(0.);
+	}
 	
 	// Get all the sound files in the game data and all plugins.
 	for(const string &source : sources)
@@ -157,17 +210,30 @@ void Audio::Init(const vector<string> &sources)
 				size_t end = path.length() - 4;
 				if(path[end - 1] == '~')
 					--end;
-				loadQueue[path.substr(root.length(), end - root.length())] = path;
+				string name = path.substr(root.length(), end - root.length());
+				Sound &sound = sounds[name];
+				sound.SetQueued(true);
+				loadQueue[&sound] = SoundFile{name, path};
 			}
 		}
 	}
-	// Begin loading the files.
+	// Begin loading the files. The sounds do not depend on each other, so
+	// they can be read in parallel.
 	if(!loadQueue.empty())
-		loadThread = thread(&Load);
+	{
+		loadThreads.resize(max(4u, thread::hardware_concurrency()));
+		for(thread &t : loadThreads)
+			t = thread(&Load);
+	}
 	
 	// Create the music-streaming threads.
 	currentTrack.reset(new Music());
 	previousTrack.reset(new Music());
+	if(isNullBackend)
+	{
+		nullMusicTime = chrono::steady_clock::now();
+		return;
+	}
 	alGenSources(1, &musicSource);
 	alGenBuffers(MUSIC_BUFFERS, musicBuffers);
 	for(unsigned buffer : musicBuffers)
@@ -182,17 +248,18 @@ void Audio::Init(const vector<string> &sources)
 
 
 
-// Check the progress of loading sounds.
+// Check the progress of loading the sounds that are needed right away. All
+// the other sounds keep loading in the background after this reaches 100%.
 double Audio::Progress()
 {
+	// Only the sounds that are needed right away must be loaded before the game
+	// can begin. The rest continue loading in the background.
 	unique_lock<mutex> lock(audioMutex);
 	
-	if(loadQueue.empty())
+	if(firstDone == firstTotal)
 		return 1.;
 	
-	double done = sounds.size();
-	double total = done + loadQueue.size();
-	return done / total;
+	return static_cast<double>(firstDone) / firstTotal;
 }
 
 
@@ -209,7 +276,7 @@ double Audio::Volume()
 void Audio::SetVolume(double level)
 {
 	volume = min(1., max(0., level));
-	if(isInitialized)
+	if(isInitialized && !isNullBackend)
 		alListenerf(AL_GAIN, volume * VOLUME_SCALE);
 }
 
@@ -225,6 +292,27 @@ const Sound *Audio::Get(const string &name)
 
 
 
+// If the given sound has not been loaded yet, load it before any sounds that
+// are not as urgently needed.
+void Audio::Prioritize(const Sound *sound)
+{
+	// Sounds that are not in the load queue (because they have already been
+	// loaded, failed to load, or have no file) never need the lock.
+	if(!sound || !sound->IsQueued())
+		return;
+	
+	unique_lock<mutex> lock(audioMutex);
+	auto it = loadQueue.find(sound);
+	if(it == loadQueue.end())
+		return;
+	
+	loadFirstQueue.insert(*it);
+	loadQueue.erase(it);
+	++firstTotal;
+}
+
+
+
 // Set the listener's position, and also update any sounds that have been
 // added but deferred because they were added from a thread other than the
 // main one (the one that called Init()).
@@ -235,9 +323,9 @@ void Audio::Update(const Point &listenerPosition)
 	
 	listener = listenerPosition;
 	
-	for(const auto &it : deferred)
-		queue[it.first].Add(it.second);
-	deferred.clear();
+	Request request;
+	while(deferred.Pop(request))
+		queue[request.sound].Add(request.position);
 }
 
 
@@ -254,8 +342,17 @@ void Audio::Play(const Sound *sound)
 // "listener". This will make it softer and change the left / right balance.
 void Audio::Play(const Sound *sound, const Point &position)
 {
-	if(!isInitialized || !sound || !sound->Buffer() || !volume)
+	if(!isInitialized || !sound || !volume)
 		return;
+	// If this sound has not been loaded yet, it cannot be played this time,
+	// but make sure it will be loaded soon.
+	if(!sound->IsLoaded())
+	{
+		Prioritize(sound);
+		return;
+	}
+	
+	requestCount.fetch_add(1, memory_order_relaxed);
 	
 	// Place sounds from the main thread directly into the queue. They are from
 	// the UI, and the Engine may not be running right now to call Update().
@@ -263,8 +360,12 @@ void Audio::Play(const Sound *sound, const Point &position)
 		queue[sound].Add(position - listener);
 	else
 	{
-		unique_lock<mutex> lock(audioMutex);
-		deferred[sound].Add(position - listener);
+		// If the queue is full, so many sounds are already waiting to play that
+		// this one would not be noticed, so just drop it.
+		Request request;
+		request.sound = sound;
+		request.position = position - listener;
+		deferred.Push(request);
 	}
 }
 
@@ -287,7 +388,8 @@ void Audio::PlayMusic(const string &name)
 
 
 // Begin playing all the sounds that have been added since the last time
-// this function was called.
+// this function was called. If there are not enough sources for all of
+// them, the loudest ones are played first.
 void Audio::Step()
 {
 	if(!isInitialized)
@@ -296,7 +398,8 @@ void Audio::Step()
 	vector<Source> newSources;
 	// For each sound that is looping, see if it is going to continue. For other
 	// sounds, check if they are done playing.
-	for(const Source &source : sources)
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	for(Source &source : sources)
 	{
 		if(source.GetSound()->IsLooping())
 		{
@@ -309,16 +412,15 @@ void Audio::Step()
 			}
 			else
 			{
-				alSourcei(source.ID(), AL_LOOPING, false);
+				if(!isNullBackend)
+					alSourcei(source.ID(), AL_LOOPING, false);
 				endingSources.push_back(source.ID());
 			}
 		}
 		else
 		{
 			// Non-looping sounds: check if they're done playing.
-			ALint state;
-			alGetSourcei(source.ID(), AL_SOURCE_STATE, &state);
-			if(state == AL_PLAYING)
+			if(source.IsPlaying(now))
 				newSources.push_back(source);
 			else
 				recycledSources.push_back(source.ID());
@@ -328,8 +430,10 @@ void Audio::Step()
 	auto it = endingSources.begin();
 	while(it != endingSources.end())
 	{
-		ALint state;
-		alGetSourcei(*it, AL_SOURCE_STATE, &state);
+		// In the null backend, a looping sound stops as soon as it is released.
+		ALint state = AL_STOPPED;
+		if(!isNullBackend)
+			alGetSourcei(*it, AL_SOURCE_STATE, &state);
 		if(state == AL_PLAYING)
 		{
 			// Fade out the sound. This avoids a clicking or rasping sound if a
@@ -349,50 +453,102 @@ void Audio::Step()
 	newSources.swap(sources);
 	
 	// Now, what is left in the queue is sounds that want to play, and that do
-	// not correspond to an existing source.
+	// not correspond to an existing source. Skip any that are too far away to
+	// be heard, and give sources to the loudest of the rest first.
+	vector<pair<const Sound *, QueueEntry>> candidates;
 	for(const auto &it : queue)
+		if(it.second.Gain() >= MIN_GAIN)
+			candidates.push_back(it);
+	sort(candidates.begin(), candidates.end(),
+		[](const pair<const Sound *, QueueEntry> &a, const pair<const Sound *, QueueEntry> &b)
+		{
+			return a.second.weight > b.second.weight;
+		});
+	
+	uint64_t played = 0;
+	for(const auto &it : candidates)
 	{
 		// Use a recycled source if possible. Otherwise, create a new one.
 		unsigned source = 0;
-		if(recycledSources.empty())
+		if(!recycledSources.empty())
 		{
-			if(sources.size() >= maxSources)
-				break;
-			
-			alGenSources(1, &source);
+			source = recycledSources.back();
+			recycledSources.pop_back();
+		}
+		else if(sources.size() < maxSources)
+		{
+			if(isNullBackend)
+				source = ++nextNullSource;
+			else
+				alGenSources(1, &source);
+			// If we just tried to generate a new source and OpenAL would not
+			// give us one, we've reached this system's limit for the number of
+			// concurrent sounds.
 			if(!source)
-			{
-				// If we just tried to generate a new source and OpenAL would
-				// not give us one, we've reached this system's limit for the
-				// number of concurrent sounds.
 				maxSources = sources.size();
-				break;
-			}
+			else
+				++statistics.sourcesAllocated;
 		}
-		else
+		if(!source)
 		{
-			source = recycledSources.back();
-			recycledSources.pop_back();
+			// All the sources are in use. If this sound is more important than
+			// the least important one that is playing, cut that one off and
+			// reuse its source. Otherwise, neither this sound nor any of the
+			// quieter ones after it can be played.
+			auto weakest = min_element(sources.begin(), sources.end(),
+				[](const Source &a, const Source &b)
+				{
+					return a.Priority() < b.Priority();
+				});
+			if(weakest == sources.end() || weakest->Priority() >= it.second.weight)
+				break;
+			
+			source = weakest->ID();
+			sources.erase(weakest);
+			if(!isNullBackend)
+				alSourceStop(source);
+			++statistics.stolen;
 		}
 		// Begin playing this sound.
 		sources.emplace_back(it.first, source);
 		sources.back().Move(it.second);
-		alSourcePlay(source);
+		if(!isNullBackend)
+			alSourcePlay(source);
+		++played;
 	}
+	statistics.played += played;
+	statistics.culled += queue.size() - played;
 	queue.clear();
 	
-	// Queue up new buffers for the music, if necessary.
+	// Queue up new buffers for the music, if necessary. The null backend
+	// "plays" each chunk of music for as long as it would really take.
 	int buffersDone = 0;
-	alGetSourcei(musicSource, AL_BUFFERS_PROCESSED, &buffersDone);
+	if(!isNullBackend)
+		alGetSourcei(musicSource, AL_BUFFERS_PROCESSED, &buffersDone);
+	else
+		buffersDone = (now >= nullMusicTime);
 	if(buffersDone)
 	{
 		unsigned buffer = 0;
-		alSourceUnqueueBuffers(musicSource, 1, &buffer);
+		if(!isNullBackend)
+			alSourceUnqueueBuffers(musicSource, 1, &buffer);
 		
 		const vector<int16_t> &chunk = currentTrack->NextChunk();
+		++statistics.musicChunks;
+		if(isNullBackend)
+		{
+			// The chunk is stereo, at 44100 Hz. If the music has fallen far
+			// behind, do not try to catch up all at once.
+			auto length = chrono::duration_cast<chrono::steady_clock::duration>(
+				chrono::duration<double>(.5 * chunk.size() / 44100.));
+			nullMusicTime = max(nullMusicTime + length, now);
+		}
 		
 		if(!musicFade)
-			alBufferData(buffer, AL_FORMAT_STEREO16, &chunk.front(), 2 * chunk.size(), 44100);
+		{
+			if(!isNullBackend)
+				alBufferData(buffer, AL_FORMAT_STEREO16, &chunk.front(), 2 * chunk.size(), 44100);
+		}
 		else
 		{
 			fadeBuffer.clear();
@@ -407,8 +563,11 @@ void Audio::Step()
 				if(musicFade)
 					--musicFade;
 			}
-			alBufferData(buffer, AL_FORMAT_STEREO16, &fadeBuffer.front(), 2 * fadeBuffer.size(), 44100);
+			if(!isNullBackend)
+				alBufferData(buffer, AL_FORMAT_STEREO16, &fadeBuffer.front(), 2 * fadeBuffer.size(), 44100);
 		}
+		if(isNullBackend)
+			return;
 		
 		alSourceQueueBuffers(musicSource, 1, &buffer);
 		// Check if the source has stopped (i.e. because it ran out of buffers).
@@ -421,19 +580,40 @@ void Audio::Step()
 
 
 
+// Get the counts of the work done so far.
+Audio::Statistics Audio::GetStatistics()
+{
+	Statistics result = statistics;
+	result.requested = requestCount.load(memory_order_relaxed);
+	return result;
+}
+
+
+
 // Shut down the audio system (because we're about to quit).
 void Audio::Quit()
 {
 	// First, check if sounds are still being loaded in a separate thread, and
 	// if so interrupt that thread and wait for it to quit.
 	unique_lock<mutex> lock(audioMutex);
-	if(!loadQueue.empty())
-		loadQueue.clear();
-	if(loadThread.joinable())
+	for(const auto &it : loadQueue)
+		const_cast<Sound *>(it.first)->SetQueued(false);
+	for(const auto &it : loadFirstQueue)
+		const_cast<Sound *>(it.first)->SetQueued(false);
+	loadQueue.clear();
+	loadFirstQueue.clear();
+	lock.unlock();
+	for(thread &t : loadThreads)
+		t.join();
+	loadThreads.clear();
+	lock.lock();
+	
+	// The null backend has no OpenAL objects to delete.
+	if(isNullBackend)
 	{
-		lock.unlock();
-		loadThread.join();
-		lock.lock();
+		sources.clear();
+		endingSources.clear();
+		recycledSources.clear();
 	}
 	
 	// Now, stop and delete any OpenAL sources that are playing.
@@ -462,16 +642,20 @@ void Audio::Quit()
 	for(const auto &it : sounds)
 	{
 		ALuint id = it.second.Buffer();
-		alDeleteBuffers(1, &id);
+		if(id)
+			alDeleteBuffers(1, &id);
 	}
 	sounds.clear();
 	
 	// Clean up the music source and buffers.
 	if(isInitialized)
 	{
-		alSourceStop(musicSource);
-		alDeleteSources(1, &musicSource);
-		alDeleteBuffers(MUSIC_BUFFERS, musicBuffers);
+		if(!isNullBackend)
+		{
+			alSourceStop(musicSource);
+			alDeleteSources(1, &musicSource);
+			alDeleteBuffers(MUSIC_BUFFERS, musicBuffers);
+		}
 		currentTrack.reset();
 		previousTrack.reset();
 	}
@@ -504,11 +688,13 @@ namespace {
 	
 	
 	
-	// Combine two queue entries.
-	void QueueEntry::Add(const QueueEntry &other)
+	// Get how loud this entry will be, taking the volume setting into account.
+	double QueueEntry::Gain() const
 	{
-		sum += other.sum;
-		weight += other.weight;
+		// Move() places the source at a distance of sqrt(1 / weight), and the
+		// distance model makes the gain inversely proportional to that distance,
+		// up to full volume at the reference distance.
+		return volume * VOLUME_SCALE * min(1., sqrt(weight));
 	}
 	
 	
@@ -520,7 +706,13 @@ namespace {
 		// Give each source a small, random pitch variation. Otherwise, multiple
 		// instances of the same sound playing at slightly different times
 		// overlap and create a "grinding" interference sound.
-		alSourcef(source, AL_PITCH, 1. + (Random::Real() - Random::Real()) * .04);
+		double pitch = 1. + (Random::Real() - Random::Real()) * .04;
+		end = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+			chrono::duration<double>(sound->Duration() / pitch));
+		if(isNullBackend)
+			return;
+		
+		alSourcef(source, AL_PITCH, pitch);
 		alSourcef(source, AL_GAIN, 1.);
 		alSourcef(source, AL_REFERENCE_DISTANCE, 1.);
 		alSourcef(source, AL_ROLLOFF_FACTOR, 1.);
@@ -532,13 +724,17 @@ namespace {
 	
 	
 	// Reposition this source based on the given entry in a sound queue.
-	void Source::Move(const QueueEntry &entry) const
+	void Source::Move(const QueueEntry &entry)
 	{
+		// Louder sounds are more important to keep playing.
+		priority = entry.weight;
+		
 		Point angle = entry.sum / entry.weight;
 		// The source should be along the vector (angle.X(), angle.Y(), 1).
 		// The length of the vector should be sqrt(1 / weight).
 		double scale = sqrt(1. / (entry.weight * (angle.LengthSquared() + 1.)));
-		alSource3f(source, AL_POSITION, angle.X() * scale, angle.Y() * scale, scale);
+		if(!isNullBackend)
+			alSource3f(source, AL_POSITION, angle.X() * scale, angle.Y() * scale, scale);
 	}
 	
 	
@@ -559,29 +755,62 @@ namespace {
 	
 	
 	
+	// Get how important it is to keep this source playing.
+	double Source::Priority() const
+	{
+		return priority;
+	}
+	
+	
+	
+	// Check if this source is still playing its sound (if not looping).
+	bool Source::IsPlaying(chrono::steady_clock::time_point now) const
+	{
+		// There is no need to ask OpenAL about a sound until it is due to end.
+		if(now < end)
+			return true;
+		if(isNullBackend)
+			return false;
+		
+		ALint state;
+		alGetSourcei(source, AL_SOURCE_STATE, &state);
+		return (state == AL_PLAYING);
+	}
+	
+	
+	
 	// Thread entry point for loading sounds.
 	void Load()
 	{
-		string name;
-		string path;
 		while(true)
 		{
+			Sound *sound = nullptr;
+			SoundFile file;
+			bool isFirst = false;
 			{
 				unique_lock<mutex> lock(audioMutex);
-				// If this is not the first time through, remove the previous item
-				// in the queue. This is a signal that it has been loaded, so we
-				// must not remove it until after loading the file.
-				if(!path.empty() && !loadQueue.empty())
-					loadQueue.erase(loadQueue.begin());
-				if(loadQueue.empty())
+				// Take the next sound off the queue, so no other thread will try
+				// to load it. Sounds that are needed right away come first.
+				isFirst = !loadFirstQueue.empty();
+				map<const Sound *, SoundFile> &queue = (isFirst ? loadFirstQueue : loadQueue);
+				if(queue.empty())
 					return;
-				name = loadQueue.begin()->first;
-				path = loadQueue.begin()->second;
+				// The sounds all belong to this class, so they can be modified here.
+				sound = const_cast<Sound *>(queue.begin()->first);
+				file = queue.begin()->second;
+				queue.erase(queue.begin());
+				sound->SetQueued(false);
 			}
 			
 			// Unlock the mutex for the time-intensive part of the loop.
-			if(!sounds[name].Load(path))
-				Files::LogError("Unable to load sound \"" + name + "\" from path: " + path);
+			if(!sound->Load(file.path, !isNullBackend))
+				Files::LogError("Unable to load sound \"" + file.name + "\" from path: " + file.path);
+			
+			if(isFirst)
+			{
+				unique_lock<mutex> lock(audioMutex);
+				++firstDone;
+			}
 		}
 	}
 }
@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef AUDIO_H_
 #define AUDIO_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -30,10 +31,35 @@ class Sound;
 // their source stops calling the "play" function for them.
 class Audio {
 public:
-	// Begin loading sounds (in a separate thread).
-	static void Init(const std::vector<std::string> &sources);
+	// Counts of the work the audio system has done since it was initialized.
+	class Statistics {
+	public:
+		// Calls to Play() for sounds that were loaded.
+		uint64_t requested = 0;
+		// Sounds that began playing on a source.
+		uint64_t played = 0;
+		// Sounds that were requested but not played, because they were too
+		// quiet or there were no sources left for them.
+		uint64_t culled = 0;
+		// Sounds that were cut off to make room for more important ones.
+		uint64_t stolen = 0;
+		// New sources that had to be created.
+		uint64_t sourcesAllocated = 0;
+		// Blocks of music that were decoded and queued up.
+		uint64_t musicChunks = 0;
+	};
 	
-	// Check the progress of loading sounds.
+	
+public:
+	// Begin loading sounds (in separate threads). If the null backend is
+	// requested, or if no audio device can be opened, nothing is ever sent to
+	// OpenAL, but sounds and music are still loaded and "played," so all the
+	// same bookkeeping is done (e.g. for benchmarking on a machine with no
+	// sound hardware).
+	static void Init(const std::vector<std::string> &sources, bool useNullBackend = false);
+	
+	// Check the progress of loading the sounds that are needed right away. All
+	// the other sounds keep loading in the background after this reaches 100%.
 	static double Progress();
 	
 	// Get or set the volume (between 0 and 1).
@@ -42,8 +68,11 @@ public:
 	
 	// Get a pointer to the named sound. The name is the path relative to the
 	// "sound/" folder, and without ~ if it's on the end, or the extension.
-	// Do not call this function until Progress() is 100%.
+	// The sound may not be loaded yet when this returns.
 	static const Sound *Get(const std::string &name);
+	// If the given sound has not been loaded yet, load it before any sounds
+	// that are not as urgently needed.
+	static void Prioritize(const Sound *sound);
 	
 	// Set the listener's position, and also update any sounds that have been
 	// added but deferred because they were added from a thread other than the
@@ -61,9 +90,13 @@ public:
 	static void PlayMusic(const std::string &name);
 	
 	// Begin playing all the sounds that have been added since the last time
-	// this function was called.
+	// this function was called. If there are not enough sources for all of
+	// them, the loudest ones are played first.
 	static void Step();
 	
+	// Get the counts of the work done so far.
+	static Statistics GetStatistics();
+	
 	// Shut down the audio system (because we're about to quit).
 	static void Quit();
 };
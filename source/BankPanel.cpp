@@ -54,6 +54,7 @@ BankPanel::BankPanel(PlayerInfo &player)
 	// This panel should allow events it does not respond to to pass through to
 	// the underlying PlanetPanel.
 	SetTrapAllEvents(false);
+	SetIsStatic(true);
 }
 
 
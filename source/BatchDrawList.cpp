@@ -17,18 +17,17 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Screen.h"
 #include "Sprite.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
 
 namespace {
-	void Push(vector<float> &v, const Point &pos, float s, float t, float frame)
+	void Push(vector<float> &v, const Point &pos, float s, float t, float frame, float layer, float frames)
 	{
-		v.push_back(pos.X());
-		v.push_back(pos.Y());
-		v.push_back(s);
-		v.push_back(t);
-		v.push_back(frame);
+		const float vertex[7] = {
+			static_cast<float>(pos.X()), static_cast<float>(pos.Y()), s, t, frame, layer, frames};
+		v.insert(v.end(), vertex, vertex + 7);
 	}
 }
 
@@ -37,7 +36,14 @@ namespace {
 // Clear the list, also setting the global time step for animation.
 void BatchDrawList::Clear(int step, double zoom)
 {
-	data.clear();
+	// Drop any batches that were not used at all in the last frame, and clear
+	// the rest without freeing their memory.
+	batches.erase(remove_if(batches.begin(), batches.end(),
+		[](const Batch &batch) { return batch.data.empty(); }), batches.end());
+	for(Batch &batch : batches)
+		batch.data.clear();
+	last = 0;
+	
 	this->step = step;
 	this->zoom = zoom;
 	isHighDPI = (Screen::IsHighResolution() ? zoom > .5 : zoom > 1.);
@@ -59,10 +65,19 @@ bool BatchDrawList::Add(const Body &body, double clip)
 	if(Cull(body, position))
 		return false;
 	
-	// Get the data vector for this particular sprite.
-	vector<float> &v = data[body.GetSprite()];
+	// Get the data vector for this particular sprite. Its texture is only
+	// looked up when drawing, because it may be loaded or unloaded at any time
+	// by the main thread. Until then, assume the whole texture is used,
+	// starting from its first layer.
+	const Sprite *sprite = body.GetSprite();
+	vector<float> &v = Data(sprite);
 	// The sprite frame is the same for every vertex.
 	float frame = body.GetFrame(step);
+	float frames = sprite->Frames();
+	float layer = 0.f;
+	float s = 1.f;
+	float t = 1.f;
+	float clipT = 1. - clip;
 	
 	// Get unit vectors in the direction of the object's width and height.
 	Point unit = body.Unit() * zoom;
@@ -82,12 +97,12 @@ bool BatchDrawList::Add(const Body &body, double clip)
 	
 	// Push two copies of the first and last vertices to mark the break between
 	// the sprites.
-	Push(v, topLeft, 0.f, 1.f, frame);
-	Push(v, topLeft, 0.f, 1.f, frame);
-	Push(v, topRight, 1.f, 1.f, frame);
-	Push(v, bottomLeft, 0.f, 1.f - clip, frame);
-	Push(v, bottomRight, 1.f, 1.f - clip, frame);
-	Push(v, bottomRight, 1.f, 1.f - clip, frame);
+	Push(v, topLeft, 0.f, t, frame, layer, frames);
+	Push(v, topLeft, 0.f, t, frame, layer, frames);
+	Push(v, topRight, s, t, frame, layer, frames);
+	Push(v, bottomLeft, 0.f, clipT, frame, layer, frames);
+	Push(v, bottomRight, s, clipT, frame, layer, frames);
+	Push(v, bottomRight, s, clipT, frame, layer, frames);
 	
 	return true;
 }
@@ -97,16 +112,67 @@ bool BatchDrawList::Add(const Body &body, double clip)
 // Draw all the items in this list.
 void BatchDrawList::Draw() const
 {
+	// Drop any atlases that were not used the last time this list was drawn,
+	// and clear the rest without freeing their memory.
+	atlasBatches.erase(remove_if(atlasBatches.begin(), atlasBatches.end(),
+		[](const AtlasBatch &batch) { return batch.data.empty(); }), atlasBatches.end());
+	for(AtlasBatch &batch : atlasBatches)
+		batch.data.clear();
+	drawCount = 0;
+	
 	BatchShader::Bind();
 	
-	for(const pair<const Sprite *, vector<float>> &it : data)
-		BatchShader::Add(it.first, isHighDPI, it.second);
+	for(const Batch &batch : batches)
+	{
+		if(batch.data.empty())
+			continue;
+		
+		// If this sprite is in an atlas, draw it from there instead of from its
+		// own texture, so it can be drawn along with other sprites.
+		uint32_t texture = batch.sprite->Texture(isHighDPI);
+		const Sprite::AtlasRegion &region = batch.sprite->Atlas(isHighDPI);
+		if(region.texture)
+		{
+			vector<float> &v = AtlasData(region.texture);
+			size_t start = v.size();
+			v.insert(v.end(), batch.data.begin(), batch.data.end());
+			
+			float s = region.scale.X();
+			float t = region.scale.Y();
+			float layer = region.layer;
+			for(size_t i = start; i < v.size(); i += 7)
+			{
+				v[i + 2] *= s;
+				v[i + 3] *= t;
+				v[i + 5] = layer;
+			}
+		}
+		else if(texture)
+		{
+			BatchShader::Add(texture, batch.data);
+			++drawCount;
+		}
+	}
+	for(const AtlasBatch &batch : atlasBatches)
+		if(!batch.data.empty())
+		{
+			BatchShader::Add(batch.texture, batch.data);
+			++drawCount;
+		}
 	
 	BatchShader::Unbind();
 }
 
 
 
+// Get the number of draw commands it took to draw this list.
+int BatchDrawList::DrawCount() const
+{
+	return drawCount;
+}
+
+
+
 bool BatchDrawList::Cull(const Body &body, const Point &position) const
 {
 	if(!body.HasSprite() || !body.Zoom())
@@ -127,3 +193,33 @@ bool BatchDrawList::Cull(const Body &body, const Point &position) const
 	
 	return false;
 }
+
+
+
+// Get the vertex data for the batch that draws the given sprite.
+vector<float> &BatchDrawList::Data(const Sprite *sprite)
+{
+	// Consecutive objects often use the same sprite.
+	if(last < batches.size() && batches[last].sprite == sprite)
+		return batches[last].data;
+	
+	for(last = 0; last < batches.size(); ++last)
+		if(batches[last].sprite == sprite)
+			return batches[last].data;
+	
+	batches.push_back(Batch{sprite, vector<float>()});
+	return batches.back().data;
+}
+
+
+
+// Get the vertex data for the batch that draws from the given atlas.
+vector<float> &BatchDrawList::AtlasData(uint32_t texture) const
+{
+	for(AtlasBatch &batch : atlasBatches)
+		if(batch.texture == texture)
+			return batch.data;
+	
+	atlasBatches.push_back(AtlasBatch{texture, vector<float>()});
+	return atlasBatches.back().data;
+}
@@ -15,7 +15,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Point.h"
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 class Body;
@@ -24,7 +25,9 @@ class Sprite;
 
 
 // This class collects a set of OpenGL draw commands to issue and groups them by
-// sprite, so all instances of each sprite can be drawn with a single command.
+// texture, so all instances of each sprite can be drawn with a single command.
+// Small sprites share atlas textures, so all of them that are in the same
+// atlas are drawn with a single command, too.
 class BatchDrawList {
 public:
 	// Clear the list, also setting the global time step for animation.
@@ -36,10 +39,16 @@ public:
 	
 	// Draw all the items in this list.
 	void Draw() const;
+	// Get the number of draw commands it took to draw this list.
+	int DrawCount() const;
 	
 	
 private:
 	bool Cull(const Body &body, const Point &position) const;
+	// Get the vertex data for the batch that draws the given sprite.
+	std::vector<float> &Data(const Sprite *sprite);
+	// Get the vertex data for the batch that draws from the given atlas.
+	std::vector<float> &AtlasData(uint32_t texture) const;
 	
 	
 private:
@@ -50,9 +59,35 @@ private:
 	
 	// Each sprite consists of six vertices (four vertices to form a quad and
 	// two dummy vertices to mark the break in between them). Each of those
-	// vertices has five attributes: (x, y) position in pixels, (s, t) texture
-	// coordinates, and the index of the sprite frame.
-	std::map<const Sprite *, std::vector<float>> data;
+	// vertices has seven attributes: (x, y) position in pixels, (s, t) texture
+	// coordinates, the index of the sprite frame, and the first layer and
+	// number of layers that the sprite's frames take up in the texture. The
+	// list is filled in by the calculation thread, which must not look up the
+	// sprites' textures, so the texture coordinates and first layer are for a
+	// sprite with a texture of its own. Sprites that are in an atlas have them
+	// adjusted when the list is drawn.
+	class Batch {
+	public:
+		const Sprite *sprite;
+		std::vector<float> data;
+	};
+	// There are usually only a few sprites in use, so a flat list is the
+	// fastest way to find each one. Clearing the list keeps every batch that
+	// was used in the last frame, and the memory that it allocated, so most
+	// frames do not need to allocate any memory at all.
+	std::vector<Batch> batches;
+	// The index of the batch that was used most recently.
+	size_t last = 0;
+	
+	// When the list is drawn, all the sprites in the same atlas are gathered
+	// into one batch, so they can be drawn with a single command.
+	class AtlasBatch {
+	public:
+		uint32_t texture;
+		std::vector<float> data;
+	};
+	mutable std::vector<AtlasBatch> atlasBatches;
+	mutable int drawCount = 0;
 };
 
 
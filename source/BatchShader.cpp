@@ -14,7 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Screen.h"
 #include "Shader.h"
-#include "Sprite.h"
+#include "StreamBuffer.h"
 
 using namespace std;
 
@@ -22,13 +22,18 @@ namespace {
 	Shader shader;
 	// Uniforms:
 	GLint scaleI;
-	GLint frameCountI;
 	// Vertex data:
 	GLint vertI;
 	GLint texCoordI;
+	GLint layersI;
 	
 	GLuint vao;
 	GLuint vbo;
+	
+	// Each vertex has seven floats.
+	const GLsizeiptr VERTEX_SIZE = 7 * sizeof(float);
+	// Each batch's vertex data is streamed into the VBO.
+	StreamBuffer buffer(1 << 20);
 }
 
 
@@ -40,38 +45,41 @@ void BatchShader::Init()
 		"uniform vec2 scale;\n"
 		"in vec2 vert;\n"
 		"in vec3 texCoord;\n"
+		"in vec2 layers;\n"
 		
 		"out vec3 fragTexCoord;\n"
+		"flat out vec2 fragLayers;\n"
 		
 		"void main() {\n"
 		"  gl_Position = vec4(vert * scale, 0, 1);\n"
 		"  fragTexCoord = texCoord;\n"
+		"  fragLayers = layers;\n"
 		"}\n";
 	
 	static const char *fragmentCode =
 		"uniform sampler2DArray tex;\n"
-		"uniform float frameCount;\n"
 		
 		"in vec3 fragTexCoord;\n"
+		"flat in vec2 fragLayers;\n"
 		
 		"out vec4 finalColor;\n"
 		
 		"void main() {\n"
 		"  float first = floor(fragTexCoord.z);\n"
-		"  float second = mod(ceil(fragTexCoord.z), frameCount);\n"
+		"  float second = mod(ceil(fragTexCoord.z), fragLayers.y);\n"
 		"  float fade = fragTexCoord.z - first;\n"
 		"  finalColor = mix(\n"
-		"    texture(tex, vec3(fragTexCoord.xy, first)),\n"
-		"    texture(tex, vec3(fragTexCoord.xy, second)), fade);\n"
+		"    texture(tex, vec3(fragTexCoord.xy, fragLayers.x + first)),\n"
+		"    texture(tex, vec3(fragTexCoord.xy, fragLayers.x + second)), fade);\n"
 		"}\n";
 	
 	// Compile the shaders.
 	shader = Shader(vertexCode, fragmentCode);
 	// Get the indices of the uniforms and attributes.
 	scaleI = shader.Uniform("scale");
-	frameCountI = shader.Uniform("frameCount");
 	vertI = shader.Attrib("vert");
 	texCoordI = shader.Attrib("texCoord");
+	layersI = shader.Attrib("layers");
 	
 	// Make sure we're using texture 0.
 	glUseProgram(shader.Object());
@@ -85,11 +93,13 @@ void BatchShader::Init()
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	
-	// In this VAO, enable the two vertex arrays and specify their byte offsets.
+	// In this VAO, enable the three vertex arrays and specify their byte offsets.
 	glEnableVertexAttribArray(vertI);
-	glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+	glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE, (void *)0);
 	glEnableVertexAttribArray(texCoordI);
-	glVertexAttribPointer(texCoordI, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(2 * sizeof(float)));
+	glVertexAttribPointer(texCoordI, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE, (void *)(2 * sizeof(float)));
+	glEnableVertexAttribArray(layersI);
+	glVertexAttribPointer(layersI, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE, (void *)(5 * sizeof(float)));
 	
 	// Unbind the buffer and the VAO, but leave the vertex attrib arrays enabled
 	// in the VAO so they will be used when it is bound.
@@ -113,22 +123,19 @@ void BatchShader::Bind()
 
 
 
-void BatchShader::Add(const Sprite *sprite, bool isHighDPI, const vector<float> &data)
+void BatchShader::Add(uint32_t texture, const vector<float> &data)
 {
 	// Do nothing if there are no sprites to draw.
 	if(data.empty())
 		return;
 	
 	// First, bind the proper texture.
-	glBindTexture(GL_TEXTURE_2D_ARRAY, sprite->Texture(isHighDPI));
-	// The shader also needs to know how many frames the texture has.
-	glUniform1f(frameCountI, sprite->Frames());
-	
-	// Upload the vertex data.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * data.size(), data.data(), GL_STREAM_DRAW);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
 	
-	// Draw all the vertices.
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, data.size() / 5);
+	// Upload the vertex data and draw all the vertices.
+	GLsizeiptr size = sizeof(float) * data.size();
+	GLsizeiptr offset = buffer.Upload(data.data(), size);
+	glDrawArrays(GL_TRIANGLE_STRIP, offset / VERTEX_SIZE, size / VERTEX_SIZE);
 }
 
 
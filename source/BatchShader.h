@@ -13,21 +13,22 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef BATCH_SHADER_H_
 #define BATCH_SHADER_H_
 
-class Sprite;
-
+#include <cstdint>
 #include <vector>
 
 
 
 // Class for drawing sprites in a batch. The input to each draw command is a
-// sprite, whether it should be drawn high DPI, and the vertex data.
+// texture and the vertex data for all the sprites to draw from it. The vertex
+// data says which layers of the texture each sprite uses, so one texture can
+// hold many different sprites.
 class BatchShader {
 public:
 	// Initialize the shaders.
 	static void Init();
 	
 	static void Bind();
-	static void Add(const Sprite *sprite, bool isHighDPI, const std::vector<float> &data);
+	static void Add(uint32_t texture, const std::vector<float> &data);
 	static void Unbind();
 };
 
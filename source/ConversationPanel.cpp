@@ -51,6 +51,8 @@ namespace {
 ConversationPanel::ConversationPanel(PlayerInfo &player, const Conversation &conversation, const System *system, const Ship *ship)
 	: player(player), conversation(conversation), scroll(0.), system(system)
 {
+	SetIsStatic(true);
+	
 	// These substitutions need to be applied on the fly as each paragraph of
 	// text is prepared for display.
 	subs["<first>"] = player.FirstName();
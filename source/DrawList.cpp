@@ -115,9 +115,20 @@ void DrawList::Draw() const
 {
 	SpriteShader::Bind();
 	
+	// Draw each run of consecutive items that share a texture and swizzle
+	// with a single command. Items are never reordered, because that would
+	// change which of them are drawn on top when they overlap. Objects of the
+	// same kind (e.g. the asteroids in a field) are usually added together.
 	bool withBlur = Preferences::Has("Render motion blur");
-	for(const SpriteShader::Item &item : items)
-		SpriteShader::Add(item, withBlur);
+	for(size_t i = 0; i < items.size(); )
+	{
+		size_t end = i + 1;
+		while(end < items.size() && items[end].texture == items[i].texture
+				&& items[end].swizzle == items[i].swizzle)
+			++end;
+		SpriteShader::Add(&items[i], end - i, withBlur);
+		i = end;
+	}
 	
 	SpriteShader::Unbind();
 }
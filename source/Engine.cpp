@@ -25,6 +25,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "MapPanel.h"
 #include "Mask.h"
 #include "Messages.h"
+#include "Outfit.h"
 #include "OutlineShader.h"
 #include "Person.h"
 #include "Planet.h"
@@ -147,7 +148,47 @@ namespace {
 		Messages::Add(tag + message);
 	}
 	
+	// Load the sounds of this ship's weapons and engines before any sounds
+	// that are not needed in the current system.
+	void PrioritizeSounds(const Ship &ship)
+	{
+		for(const auto &it : ship.Outfits())
+		{
+			Audio::Prioritize(it.first->WeaponSound());
+			for(const auto &sit : it.first->FlareSounds())
+				Audio::Prioritize(sit.first);
+		}
+	}
+	
 	const double RADAR_SCALE = .025;
+	
+	// Indices of the information shown in the HUD, so that it can be filled
+	// in every frame without looking up any names.
+	const int PLAYER_SPRITE = Information::Index("player sprite");
+	const int LOCATION = Information::Index("location");
+	const int DATE = Information::Index("date");
+	const int FUEL = Information::Index("fuel");
+	const int ENERGY = Information::Index("energy");
+	const int HEAT = Information::Index("heat");
+	const int SHIELDS = Information::Index("shields");
+	const int HULL = Information::Index("hull");
+	const int CREDITS = Information::Index("credits");
+	const int NAVIGATION_MODE = Information::Index("navigation mode");
+	const int DESTINATION = Information::Index("destination");
+	const int TARGET_NAME = Information::Index("target name");
+	const int TARGET_SPRITE = Information::Index("target sprite");
+	const int RANGE_DISPLAY = Information::Index("range display");
+	const int TARGET_RANGE = Information::Index("target range");
+	const int TARGET_TYPE = Information::Index("target type");
+	const int TARGET_GOVERNMENT = Information::Index("target government");
+	const int MISSION_TARGET = Information::Index("mission target");
+	const int TARGET_SHIELDS = Information::Index("target shields");
+	const int TARGET_HULL = Information::Index("target hull");
+	const int TACTICAL_DISPLAY = Information::Index("tactical display");
+	const int TARGET_CREW = Information::Index("target crew");
+	const int TARGET_FUEL = Information::Index("target fuel");
+	const int TARGET_ENERGY = Information::Index("target energy");
+	const int TARGET_HEAT = Information::Index("target heat");
 }
 
 
@@ -164,7 +205,9 @@ Engine::Engine(PlayerInfo &player)
 	if(!player.IsLoaded() || !player.GetSystem())
 		return;
 	
-	// Preload any landscapes for this system.
+	// Preload any landscapes for this system, and make sure its sprites are
+	// loaded before any others that are still waiting.
+	GameData::Prioritize(player.GetSystem());
 	for(const StellarObject &object : player.GetSystem()->Objects())
 		if(object.GetPlanet())
 			GameData::Preload(object.GetPlanet()->Landscape());
@@ -529,28 +572,28 @@ void Engine::Step(bool isActive)
 		Messages::Add("Your ship has overheated.");
 	
 	// Clear the HUD information from the previous frame.
-	info = Information();
+	info.Clear();
 	if(flagship && flagship->Hull())
 	{
 		Point shipFacingUnit(0., -1.);
 		if(Preferences::Has("Rotate flagship in HUD"))
 			shipFacingUnit = flagship->Facing().Unit();
 		
-		info.SetSprite("player sprite", flagship->GetSprite(), shipFacingUnit, flagship->GetFrame(step));
+		info.SetSprite(PLAYER_SPRITE, flagship->GetSprite(), shipFacingUnit, flagship->GetFrame(step));
 	}
 	if(currentSystem)
-		info.SetString("location", currentSystem->Name());
-	info.SetString("date", player.GetDate().ToString());
+		info.SetString(LOCATION, currentSystem->Name());
+	info.SetString(DATE, player.GetDate().ToString());
 	if(flagship)
 	{
-		info.SetBar("fuel", flagship->Fuel(),
+		info.SetBar(FUEL, flagship->Fuel(),
 			flagship->Attributes().Get("fuel capacity") * .01);
-		info.SetBar("energy", flagship->Energy());
-		info.SetBar("heat", flagship->Heat());
-		info.SetBar("shields", flagship->Shields());
-		info.SetBar("hull", flagship->Hull(), 20.);
+		info.SetBar(ENERGY, flagship->Energy());
+		info.SetBar(HEAT, flagship->Heat());
+		info.SetBar(SHIELDS, flagship->Shields());
+		info.SetBar(HULL, flagship->Hull(), 20.);
 	}
-	info.SetString("credits",
+	info.SetString(CREDITS,
 		Format::Number(player.Accounts().Credits()) + " credits");
 	bool isJumping = flagship && (flagship->Commands().Has(Command::JUMP) || flagship->IsEnteringHyperspace());
 	if(flagship && flagship->GetTargetStellar() && !isJumping)
@@ -559,9 +602,9 @@ void Engine::Step(bool isActive)
 		string navigationMode = flagship->Commands().Has(Command::LAND) ? "Landing on:" :
 			object->GetPlanet() && object->GetPlanet()->CanLand(*flagship) ? "Can land on:" :
 			"Cannot land on:";
-		info.SetString("navigation mode", navigationMode);
+		info.SetString(NAVIGATION_MODE, navigationMode);
 		const string &name = object->Name();
-		info.SetString("destination", name);
+		info.SetString(DESTINATION, name);
 		
 		targets.push_back({
 			object->Position() - center,
@@ -572,16 +615,16 @@ void Engine::Step(bool isActive)
 	}
 	else if(flagship && flagship->GetTargetSystem())
 	{
-		info.SetString("navigation mode", "Hyperspace:");
+		info.SetString(NAVIGATION_MODE, "Hyperspace:");
 		if(player.HasVisited(flagship->GetTargetSystem()))
-			info.SetString("destination", flagship->GetTargetSystem()->Name());
+			info.SetString(DESTINATION, flagship->GetTargetSystem()->Name());
 		else
-			info.SetString("destination", "unexplored system");
+			info.SetString(DESTINATION, "unexplored system");
 	}
 	else
 	{
-		info.SetString("navigation mode", "Navigation:");
-		info.SetString("destination", "no destination");
+		info.SetString(NAVIGATION_MODE, "Navigation:");
+		info.SetString(DESTINATION, "no destination");
 	}
 	// Use the radar that was just populated. (The draw tick-tock has not
 	// yet been toggled, but it will be at the end of this function.)
@@ -600,22 +643,22 @@ void Engine::Step(bool isActive)
 	if(!target)
 		targetSwizzle = -1;
 	if(!target && !targetAsteroid)
-		info.SetString("target name", "no target");
+		info.SetString(TARGET_NAME, "no target");
 	else if(!target)
 	{
-		info.SetSprite("target sprite",
+		info.SetSprite(TARGET_SPRITE,
 			targetAsteroid->GetSprite(),
 			targetAsteroid->Facing().Unit(),
 			targetAsteroid->GetFrame(step));
-		info.SetString("target name", Format::Capitalize(targetAsteroid->Name()) + " Asteroid");
+		info.SetString(TARGET_NAME, Format::Capitalize(targetAsteroid->Name()) + " Asteroid");
 		
 		targetVector = targetAsteroid->Position() - center;
 		
 		if(flagship->Attributes().Get("tactical scan power"))
 		{
-			info.SetCondition("range display");
+			info.SetCondition(RANGE_DISPLAY);
 			int targetRange = round(targetAsteroid->Position().Distance(flagship->Position()));
-			info.SetString("target range", to_string(targetRange));
+			info.SetString(TARGET_RANGE, to_string(targetRange));
 		}
 	}
 	else
@@ -623,23 +666,23 @@ void Engine::Step(bool isActive)
 		const Font &font = FontSet::Get(14);
 		if(target->GetSystem() == player.GetSystem() && target->Cloaking() < 1.)
 			targetUnit = target->Facing().Unit();
-		info.SetSprite("target sprite", target->GetSprite(), targetUnit, target->GetFrame(step));
-		info.SetString("target name", font.TruncateMiddle(target->Name(), 150));
-		info.SetString("target type", target->ModelName());
+		info.SetSprite(TARGET_SPRITE, target->GetSprite(), targetUnit, target->GetFrame(step));
+		info.SetString(TARGET_NAME, font.TruncateMiddle(target->Name(), 150));
+		info.SetString(TARGET_TYPE, target->ModelName());
 		if(!target->GetGovernment())
-			info.SetString("target government", "No Government");
+			info.SetString(TARGET_GOVERNMENT, "No Government");
 		else
-			info.SetString("target government", target->GetGovernment()->GetName());
+			info.SetString(TARGET_GOVERNMENT, target->GetGovernment()->GetName());
 		targetSwizzle = target->GetSwizzle();
-		info.SetString("mission target", target->GetPersonality().IsTarget() ? "(mission target)" : "");
+		info.SetString(MISSION_TARGET, target->GetPersonality().IsTarget() ? "(mission target)" : "");
 		
 		int targetType = RadarType(*target, step);
 		info.SetOutlineColor(Radar::GetColor(targetType));
 		if(target->GetSystem() == player.GetSystem() && target->IsTargetable())
 		{
-			info.SetBar("target shields", target->Shields());
-			info.SetBar("target hull", target->Hull(), 20.);
-		
+			info.SetBar(TARGET_SHIELDS, target->Shields());
+			info.SetBar(TARGET_HULL, target->Hull(), 20.);
+			
 			// The target area will be a square, with sides proportional to the average
 			// of the width and the height of the sprite.
 			double size = (target->Width() + target->Height()) * .35;
@@ -657,22 +700,22 @@ void Engine::Step(bool isActive)
 			double targetRange = target->Position().Distance(flagship->Position());
 			if(tacticalRange)
 			{
-				info.SetCondition("range display");
-				info.SetString("target range", to_string(static_cast<int>(round(targetRange))));
+				info.SetCondition(RANGE_DISPLAY);
+				info.SetString(TARGET_RANGE, to_string(static_cast<int>(round(targetRange))));
 			}
 			// Actual tactical information requires a scrutable
 			// target that is within the tactical scanner range.
 			if((targetRange <= tacticalRange && !target->Attributes().Get("inscrutable"))
 					|| (tacticalRange && target->IsYours()))
 			{
-				info.SetCondition("tactical display");
-				info.SetString("target crew", to_string(target->Crew()));
+				info.SetCondition(TACTICAL_DISPLAY);
+				info.SetString(TARGET_CREW, to_string(target->Crew()));
 				int fuel = round(target->Fuel() * target->Attributes().Get("fuel capacity"));
-				info.SetString("target fuel", to_string(fuel));
+				info.SetString(TARGET_FUEL, to_string(fuel));
 				int energy = round(target->Energy() * target->Attributes().Get("energy capacity"));
-				info.SetString("target energy", to_string(energy));
+				info.SetString(TARGET_ENERGY, to_string(energy));
 				int heat = round(100. * target->Heat());
-				info.SetString("target heat", to_string(heat) + "%");
+				info.SetString(TARGET_HEAT, to_string(heat) + "%");
 			}
 		}
 	}
@@ -875,7 +918,7 @@ void Engine::Draw() const
 	// Draw the faction markers.
 	if(targetSwizzle >= 0 && interface->HasPoint("faction markers"))
 	{
-		int width = font.Width(info.GetString("target government"));
+		int width = font.Width(info.GetString(TARGET_GOVERNMENT));
 		Point center = interface->GetPoint("faction markers");
 		
 		const Sprite *mark[2] = {SpriteSet::Get("ui/faction left"), SpriteSet::Get("ui/faction right")};
@@ -934,7 +977,8 @@ void Engine::Draw() const
 	
 	if(Preferences::Has("Show CPU / GPU load"))
 	{
-		string loadString = to_string(lround(load * 100.)) + "% CPU";
+		string loadString = to_string(lround(load * 100.)) + "% CPU, "
+			+ to_string(batchDraw[drawTickTock].DrawCount()) + " batches";
 		Color color = *colors.Get("medium");
 		font.Draw(loadString,
 			Point(-10 - font.Width(loadString), Screen::Height() * -.5 + 5.), color);
@@ -1019,6 +1063,7 @@ void Engine::EnterSystem()
 			"." : ". No inhabited planets detected."));
 	
 	// Preload landscapes and determine if the player used a wormhole.
+	GameData::Prioritize(system);
 	const StellarObject *usedWormhole = nullptr;
 	for(const StellarObject &object : system->Objects())
 		if(object.GetPlanet())
@@ -1102,6 +1147,15 @@ void Engine::EnterSystem()
 	newVisuals.clear();
 	newFlotsam.clear();
 	
+	// Load the sounds the ships in this system will make before any others.
+	// The player's ships are not in the list yet if they just took off.
+	for(const shared_ptr<Ship> &ship : ships)
+		if(ship->GetSystem() == system)
+			PrioritizeSounds(*ship);
+	for(const shared_ptr<Ship> &ship : player.Ships())
+		if(ship->GetSystem() == system && !ship->IsParked())
+			PrioritizeSounds(*ship);
+	
 	// Help message for new players. Show this message for the first four days,
 	// since the new player ships can make at most four jumps before landing.
 	if(today <= GameData::Start().GetDate() + 4)
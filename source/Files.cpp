@@ -24,11 +24,17 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include <dirent.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <mutex>
+#include <queue>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 
 using namespace std;
 
@@ -40,6 +46,7 @@ namespace {
 	string images;
 	string sounds;
 	string saves;
+	string cache;
 	
 	mutex errorMutex;
 	FILE *errorLog = nullptr;
@@ -79,6 +86,88 @@ namespace {
 		return result;
 	}
 #endif
+	
+	// Get everything in the given directory (which must end in a slash), in
+	// the order the operating system lists it. Each entry is a path, plus a
+	// flag that is set if it is a directory. Directory paths end in a slash.
+	vector<pair<string, bool>> ListEntries(const string &directory)
+	{
+		vector<pair<string, bool>> entries;
+#if defined _WIN32
+		WIN32_FIND_DATAW ffd;
+		HANDLE hFind = FindFirstFileW(ToUTF16(directory + '*').c_str(), &ffd);
+		if(hFind == INVALID_HANDLE_VALUE)
+			return entries;
+		
+		do {
+			if(!ffd.cFileName || ffd.cFileName[0] == '.')
+				continue;
+			
+			if(!(ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+				entries.emplace_back(directory + ToUTF8(ffd.cFileName), false);
+			else
+				entries.emplace_back(directory + ToUTF8(ffd.cFileName) + '/', true);
+		} while(FindNextFileW(hFind, &ffd));
+		
+		FindClose(hFind);
+#else
+		DIR *dir = opendir(directory.c_str());
+		if(!dir)
+			return entries;
+		
+		while(true)
+		{
+			dirent *ent = readdir(dir);
+			if(!ent)
+				break;
+			// Skip dotfiles (including "." and "..").
+			if(ent->d_name[0] == '.')
+				continue;
+			
+			string name = directory + ent->d_name;
+			// Don't assume that this operating system's implementation of dirent
+			// includes the t_type field; in particular, on Windows it will not.
+			struct stat buf;
+			stat(name.c_str(), &buf);
+			bool isRegularFile = S_ISREG(buf.st_mode);
+			bool isDirectory = S_ISDIR(buf.st_mode);
+			
+			if(isRegularFile)
+				entries.emplace_back(name, false);
+			else if(isDirectory)
+				entries.emplace_back(name + '/', true);
+		}
+		
+		closedir(dir);
+#endif
+		return entries;
+	}
+	
+	// A single directory within a set of directory trees that are being
+	// scanned in parallel.
+	class ScanNode {
+	public:
+		// Which of the directory trees this belongs to.
+		size_t root = 0;
+		string path;
+		vector<pair<string, bool>> entries;
+		// The node for each subdirectory, in the same order as the entries.
+		vector<const ScanNode *> children;
+	};
+	
+	// Add all the files in the given node to the list, in the same order that
+	// a recursive scan in a single thread would.
+	void Flatten(const ScanNode &node, vector<string> *list)
+	{
+		auto child = node.children.begin();
+		for(const pair<string, bool> &entry : node.entries)
+		{
+			if(entry.second)
+				Flatten(**child++, list);
+			else
+				list->push_back(entry.first);
+		}
+	}
 }
 
 
@@ -182,6 +271,18 @@ void Files::Init(const char * const *argv)
 		throw runtime_error("Unable to find the resource directories!");
 	if(!Exists(saves))
 		throw runtime_error("Unable to create config directory!");
+	
+	// Create the cache directory if it does not exist. If that fails, the game
+	// still works; it just has to regenerate everything on every launch.
+	cache = config + "cache/";
+	if(!Exists(cache))
+	{
+#if defined _WIN32
+		CreateDirectoryW(ToUTF16(cache).c_str(), nullptr);
+#else
+		mkdir(cache.c_str(), 0755);
+#endif
+	}
 }
 
 
@@ -228,6 +329,15 @@ const string &Files::Saves()
 
 
 
+// Get the directory where data that can be regenerated from the resources
+// (e.g. decoded images) is stored to speed up loading.
+const string &Files::Cache()
+{
+	return cache;
+}
+
+
+
 vector<string> Files::List(string directory)
 {
 	if(directory.empty() || directory.back() != '/')
@@ -355,53 +465,116 @@ void Files::RecursiveList(string directory, vector<string> *list)
 	if(directory.empty() || directory.back() != '/')
 		directory += '/';
 	
-#if defined _WIN32
-	WIN32_FIND_DATAW ffd;
-	HANDLE hFind = FindFirstFileW(ToUTF16(directory + '*').c_str(), &ffd);
-	if(hFind == INVALID_HANDLE_VALUE)
-		return;
-	
-	do {
-		if(!ffd.cFileName || ffd.cFileName[0] == '.')
-			continue;
-		
-		if(!(ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-			list->push_back(directory + ToUTF8(ffd.cFileName));
+	for(const pair<string, bool> &entry : ListEntries(directory))
+	{
+		if(entry.second)
+			RecursiveList(entry.first, list);
 		else
-			RecursiveList(directory + ToUTF8(ffd.cFileName) + '/', list);
-	} while(FindNextFileW(hFind, &ffd));
+			list->push_back(entry.first);
+	}
+}
+
+
+
+// Scan several directory trees at once, using a pool of threads. Each of the
+// returned lists is in the same order that RecursiveList() would return.
+vector<vector<string>> Files::RecursiveList(const vector<string> &directories, const ScanCallback &callback)
+{
+	// A deque is used so that adding nodes never moves the existing ones.
+	deque<ScanNode> nodes;
+	queue<ScanNode *> toScan;
+	queue<const ScanNode *> scanned;
+	// This is the number of nodes that have not been scanned yet.
+	size_t pending = 0;
+	mutex scanMutex;
+	condition_variable scanCondition;
+	condition_variable doneCondition;
 	
-	FindClose(hFind);
-#else
-	DIR *dir = opendir(directory.c_str());
-	if(!dir)
-		return;
+	for(size_t i = 0; i < directories.size(); ++i)
+	{
+		nodes.emplace_back();
+		nodes.back().root = i;
+		nodes.back().path = directories[i];
+		if(nodes.back().path.empty() || nodes.back().path.back() != '/')
+			nodes.back().path += '/';
+		toScan.push(&nodes.back());
+		++pending;
+	}
 	
-	while(true)
+	auto scan = [&]()
 	{
-		dirent *ent = readdir(dir);
-		if(!ent)
-			break;
-		// Skip dotfiles (including "." and "..").
-		if(ent->d_name[0] == '.')
-			continue;
-		
-		string name = directory + ent->d_name;
-		// Don't assume that this operating system's implementation of dirent
-		// includes the t_type field; in particular, on Windows it will not.
-		struct stat buf;
-		stat(name.c_str(), &buf);
-		bool isRegularFile = S_ISREG(buf.st_mode);
-		bool isDirectory = S_ISDIR(buf.st_mode);
-		
-		if(isRegularFile)
-			list->push_back(name);
-		else if(isDirectory)
-			RecursiveList(name + '/', list);
+		unique_lock<mutex> lock(scanMutex);
+		while(true)
+		{
+			while(pending && toScan.empty())
+				scanCondition.wait(lock);
+			if(!pending)
+				return;
+			
+			ScanNode *node = toScan.front();
+			toScan.pop();
+			
+			// Read the directory without holding the lock.
+			lock.unlock();
+			vector<pair<string, bool>> entries = ListEntries(node->path);
+			lock.lock();
+			
+			node->entries.swap(entries);
+			for(const pair<string, bool> &entry : node->entries)
+				if(entry.second)
+				{
+					nodes.emplace_back();
+					nodes.back().root = node->root;
+					nodes.back().path = entry.first;
+					node->children.push_back(&nodes.back());
+					toScan.push(&nodes.back());
+					++pending;
+				}
+			--pending;
+			scanned.push(node);
+			
+			scanCondition.notify_all();
+			doneCondition.notify_one();
+		}
+	};
+	vector<thread> threads(max(4u, thread::hardware_concurrency()));
+	for(thread &t : threads)
+		t = thread(scan);
+	
+	// Report each directory to the caller, in this thread, as soon as it has
+	// been scanned.
+	{
+		unique_lock<mutex> lock(scanMutex);
+		while(true)
+		{
+			while(!scanned.empty())
+			{
+				const ScanNode *node = scanned.front();
+				scanned.pop();
+				if(!callback)
+					continue;
+				
+				lock.unlock();
+				vector<string> files;
+				vector<string> subdirectories;
+				for(const pair<string, bool> &entry : node->entries)
+					(entry.second ? subdirectories : files).push_back(entry.first);
+				callback(node->root, node->path, files, subdirectories);
+				lock.lock();
+			}
+			if(!pending)
+				break;
+			doneCondition.wait(lock);
+		}
 	}
+	for(thread &t : threads)
+		t.join();
 	
-	closedir(dir);
-#endif
+	// The first nodes are the roots of each of the directory trees.
+	vector<vector<string>> lists(directories.size());
+	for(size_t i = 0; i < directories.size(); ++i)
+		Flatten(nodes[i], &lists[i]);
+	return lists;
 }
 
 
@@ -433,6 +606,23 @@ time_t Files::Timestamp(const string &filePath)
 
 
 
+// Get the size of the given file in bytes, or 0 if it does not exist.
+uint64_t Files::Size(const string &filePath)
+{
+#if defined _WIN32
+	struct _stat buf;
+	if(_wstat(ToUTF16(filePath).c_str(), &buf))
+		return 0;
+#else
+	struct stat buf;
+	if(stat(filePath.c_str(), &buf))
+		return 0;
+#endif
+	return buf.st_size;
+}
+
+
+
 void Files::Copy(const string &from, const string &to)
 {
 #if defined _WIN32
@@ -13,8 +13,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef FILES_H_
 #define FILES_H_
 
+#include <cstdint>
 #include <cstdio>
 #include <ctime>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -37,6 +39,8 @@ public:
 	static const std::string &Images();
 	static const std::string &Sounds();
 	static const std::string &Saves();
+	// Directory for data that can be regenerated, e.g. decoded images.
+	static const std::string &Cache();
 	
 	// Get a list of all regular files in the given directory.
 	static std::vector<std::string> List(std::string directory);
@@ -46,9 +50,19 @@ public:
 	// that it contains, recursively.
 	static std::vector<std::string> RecursiveList(const std::string &directory);
 	static void RecursiveList(std::string directory, std::vector<std::string> *list);
+	// Do the same for several directories at once, scanning them in parallel.
+	// Each returned list is in the same order that RecursiveList() would give.
+	// If a callback is given, it is called in this thread as soon as each
+	// directory has been scanned, with the index of the directory tree that it
+	// is in, its path, and the files and subdirectories that it contains.
+	typedef std::function<void(size_t, const std::string &, const std::vector<std::string> &,
+		const std::vector<std::string> &)> ScanCallback;
+	static std::vector<std::vector<std::string>> RecursiveList(const std::vector<std::string> &directories,
+		const ScanCallback &callback = nullptr);
 	
 	static bool Exists(const std::string &filePath);
 	static std::time_t Timestamp(const std::string &filePath);
+	static uint64_t Size(const std::string &filePath);
 	static void Copy(const std::string &from, const std::string &to);
 	static void Move(const std::string &from, const std::string &to);
 	static void Delete(const std::string &filePath);
@@ -101,7 +101,8 @@ void Flotsam::Move(vector<Visual> &visuals)
 		return;
 	
 	// This flotsam has reached the end of its life. 
-	const Effect *effect = GameData::Effects().Get("flotsam death");
+	static const Set<Effect>::Handle flotsamDeath(GameData::Effects(), "flotsam death");
+	const Effect *effect = flotsamDeath.Get();
 	for(int i = 0; i < 3; ++i)
 	{
 		Angle smokeAngle = Angle::Random();
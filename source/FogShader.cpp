@@ -21,7 +21,9 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "gl_header.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 using namespace std;
@@ -34,8 +36,8 @@ namespace {
 	const int DIAG = 7;
 	// Limit distances to the size of an unsigned char.
 	const int LIMIT = 255;
-	// Pad beyond the screen enough to include any system that might "cast light"
-	// on the on-screen view.
+	// Pad beyond the outermost systems enough that the edge of the mask is
+	// completely dark, so anything beyond it can use the edge value.
 	const int PAD = LIMIT / ORTH;
 	
 	// OpenGL objects:
@@ -46,14 +48,103 @@ namespace {
 	GLuint vbo;
 	GLuint texture = 0;
 	
-	// Keep track of the previous frame's view so that if it is unchanged we can
-	// skip regenerating the mask.
-	double previousZoom = 0.;
-	double previousLeft = 0.;
-	double previousTop = 0.;
-	int previousColumns = 0;
-	int previousRows = 0;
-	Point previousCenter;
+	// The mask covers the whole galaxy at a fixed scale, so it only needs to be
+	// regenerated when the player visits new systems, not when the view moves.
+	// This is the position of the center of the mask's top left pixel.
+	Point origin;
+	int columns = 0;
+	int rows = 0;
+	// Keep track of what the mask was generated for.
+	const PlayerInfo *previousPlayer = nullptr;
+	int previousVersion = 0;
+	bool shouldRegenerate = true;
+	
+	
+	// Generate the mask for the systems the given player has visited.
+	void Regenerate(const PlayerInfo &player)
+	{
+		// Find the bounds of the galaxy, plus enough padding beyond it to
+		// include the whole fade from the outermost systems.
+		Point topLeft(numeric_limits<double>::infinity(), numeric_limits<double>::infinity());
+		Point bottomRight = -topLeft;
+		for(const auto &it : GameData::Systems())
+			if(!it.second.Name().empty())
+			{
+				topLeft = Point(min(topLeft.X(), it.second.Position().X()), min(topLeft.Y(), it.second.Position().Y()));
+				bottomRight = Point(max(bottomRight.X(), it.second.Position().X()), max(bottomRight.Y(), it.second.Position().Y()));
+			}
+		if(topLeft.X() > bottomRight.X())
+			topLeft = bottomRight = Point();
+		
+		origin = Point(floor(topLeft.X() / GRID) - PAD, floor(topLeft.Y() / GRID) - PAD) * GRID;
+		int newColumns = ceil((bottomRight.X() - origin.X()) / GRID) + 1 + PAD;
+		int newRows = ceil((bottomRight.Y() - origin.Y()) / GRID) + 1 + PAD;
+		// Round up to a multiple of 4 so the rows will be 32-bit aligned.
+		newColumns = (newColumns + 3) & ~3;
+		bool sizeChanged = (!texture || newColumns != columns || newRows != rows);
+		columns = newColumns;
+		rows = newRows;
+		
+		// This buffer will hold the mask image.
+		vector<unsigned char> buffer(rows * columns, LIMIT);
+		
+		// For each system the player knows about, its "distance" pixel in the
+		// buffer should be set to 0.
+		for(const auto &it : GameData::Systems())
+		{
+			const System &system = it.second;
+			if(system.Name().empty() || !player.HasVisited(&system))
+				continue;
+			
+			int x = round((system.Position().X() - origin.X()) / GRID);
+			int y = round((system.Position().Y() - origin.Y()) / GRID);
+			if(x >= 0 && y >= 0 && x < columns && y < rows)
+				buffer[x + y * columns] = 0;
+		}
+		
+		// Distance transformation: make two passes through the buffer. In the first
+		// pass, propagate down and to the right. In the second, propagate in the
+		// opposite direction. Once these two passes are done, each value is equal
+		for(int y = 1; y < rows; ++y)
+			for(int x = 1; x < columns; ++x)
+				buffer[x + y * columns] = min<int>(buffer[x + y * columns], min(
+					ORTH + min(buffer[(x - 1) + y * columns], buffer[x + (y - 1) * columns]),
+					DIAG + min(buffer[(x - 1) + (y - 1) * columns], buffer[(x + 1) + (y - 1) * columns])));
+		for(int y = rows - 2; y >= 0; --y)
+			for(int x = columns - 2; x >= 0; --x)
+				buffer[x + y * columns] = min<int>(buffer[x + y * columns], min(
+					ORTH + min(buffer[(x + 1) + y * columns], buffer[x + (y + 1) * columns]),
+					DIAG + min(buffer[(x - 1) + (y + 1) * columns], buffer[(x + 1) + (y + 1) * columns])));
+		
+		// Strech the distance values so there is no shading up to about 200 pixels
+		// away, then it transitions somewhat quickly.
+		for(unsigned char &value : buffer)
+			value = max(0, min(LIMIT, (value - 60) * 4));
+		const void *data = &buffer.front();
+		
+		// Set up the OpenGL texture if it doesn't exist yet.
+		if(sizeChanged)
+		{
+			// If the texture size changed, it must be reallocated.
+			if(texture)
+				glDeleteTextures(1, &texture);
+			
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			
+			// Upload the new "image."
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, columns, rows, 0, GL_RED, GL_UNSIGNED_BYTE, data);
+		}
+		else
+		{
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns, rows, GL_RED, GL_UNSIGNED_BYTE, data);
+		}
+	}
 }
 
 
@@ -61,6 +152,8 @@ namespace {
 void FogShader::Init()
 {
 	static const char *vertexCode =
+		// The texture coordinates of the screen's top left corner, and the
+		// size of the screen in texture coordinates.
 		"uniform vec2 corner;\n"
 		"uniform vec2 dimensions;\n"
 		
@@ -68,8 +161,8 @@ void FogShader::Init()
 		"out vec2 fragTexCoord;\n"
 		
 		"void main() {\n"
-		"  gl_Position = vec4(corner + vert * dimensions, 0, 1);\n"
-		"  fragTexCoord = vert;\n"
+		"  gl_Position = vec4(2 * vert.x - 1, 1 - 2 * vert.y, 0, 1);\n"
+		"  fragTexCoord = corner + vert * dimensions;\n"
 		"}\n";
 
 	static const char *fragmentCode =
@@ -120,102 +213,20 @@ void FogShader::Init()
 
 void FogShader::Redraw()
 {
-	previousZoom = 0.;
+	shouldRegenerate = true;
 }
 
 
 
 void FogShader::Draw(const Point &center, double zoom, const PlayerInfo &player)
 {
-	// Generate a scaled-down mask image that represents the entire screen plus
-	// enough pixels beyond the screen to include any systems that may be off
-	// screen but close enough to "illuminate" part of the on-screen map.
-	double left = Screen::Left() - GRID * PAD * zoom + fmod(center.X(), GRID) * zoom;
-	double top = Screen::Top() - GRID * PAD * zoom + fmod(center.Y(), GRID) * zoom;
-	int columns = ceil(Screen::Width() / (GRID * zoom)) + 1 + 2 * PAD;
-	int rows = ceil(Screen::Height() / (GRID * zoom)) + 1 + 2 * PAD;
-	// Round up to a multiple of 4 so the rows will be 32-bit aligned.
-	columns = (columns + 3) & ~3;
-	
-	// To avoid extra work, don't regenerate the mask buffer if the view has not
-	// moved. This might cause an inaccurate mask if you explore more systems,
-	// come back to the original, and view the map again without viewing it in
-	// between. But, that's an unlikely situation.
-	bool shouldRegenerate = (
-		zoom != previousZoom || center.X() != previousCenter.X() || center.Y() != previousCenter.Y() ||
-		left != previousLeft || top != previousTop || columns != previousColumns || rows != previousRows);
-	if(shouldRegenerate)
+	// The mask only changes if the player has visited new systems.
+	if(shouldRegenerate || &player != previousPlayer || player.VisitedVersion() != previousVersion)
 	{
-		bool sizeChanged = (!texture || columns != previousColumns || rows != previousRows);
-		
-		// Remember the current viewport attributes.
-		previousZoom = zoom;
-		previousCenter = center;
-		previousLeft = left;
-		previousTop = top;
-		previousColumns = columns;
-		previousRows = rows;
-		
-		// This buffer will hold the mask image.
-		vector<unsigned char> buffer(rows * columns, LIMIT);
-	
-		// For each system the player knows about, its "distance" pixel in the
-		// buffer should be set to 0.
-		for(const auto &it : GameData::Systems())
-		{
-			const System &system = it.second;
-			if(system.Name().empty() || !player.HasVisited(&system))
-				continue;
-			Point pos = zoom * (system.Position() + center);
-		
-			int x = round((pos.X() - left) / (GRID * zoom));
-			int y = round((pos.Y() - top) / (GRID * zoom));
-			if(x >= 0 && y >= 0 && x < columns && y < rows)
-				buffer[x + y * columns] = 0;
-		}
-	
-		// Distance transformation: make two passes through the buffer. In the first
-		// pass, propagate down and to the right. In the second, propagate in the
-		// opposite direction. Once these two passes are done, each value is equal
-		for(int y = 1; y < rows; ++y)
-			for(int x = 1; x < columns; ++x)
-				buffer[x + y * columns] = min<int>(buffer[x + y * columns], min(
-					ORTH + min(buffer[(x - 1) + y * columns], buffer[x + (y - 1) * columns]),
-					DIAG + min(buffer[(x - 1) + (y - 1) * columns], buffer[(x + 1) + (y - 1) * columns])));
-		for(int y = rows - 2; y >= 0; --y)
-			for(int x = columns - 2; x >= 0; --x)
-				buffer[x + y * columns] = min<int>(buffer[x + y * columns], min(
-					ORTH + min(buffer[(x + 1) + y * columns], buffer[x + (y + 1) * columns]),
-					DIAG + min(buffer[(x - 1) + (y + 1) * columns], buffer[(x + 1) + (y + 1) * columns])));
-	
-		// Strech the distance values so there is no shading up to about 200 pixels
-		// away, then it transitions somewhat quickly.
-		for(unsigned char &value : buffer)
-			value = max(0, min(LIMIT, (value - 60) * 4));
-		const void *data = &buffer.front();
-		
-		// Set up the OpenGL texture if it doesn't exist yet.
-		if(sizeChanged)
-		{
-			// If the texture size changed, it must be reallocated.
-			if(texture)
-				glDeleteTextures(1, &texture);
-			
-			glGenTextures(1, &texture);
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			
-			// Upload the new "image."
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, columns, rows, 0, GL_RED, GL_UNSIGNED_BYTE, data);
-		}
-		else
-		{
-			glBindTexture(GL_TEXTURE_2D, texture);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns, rows, GL_RED, GL_UNSIGNED_BYTE, data);
-		}
+		shouldRegenerate = false;
+		previousPlayer = &player;
+		previousVersion = player.VisitedVersion();
+		Regenerate(player);
 	}
 	else
 		glBindTexture(GL_TEXTURE_2D, texture);
@@ -224,13 +235,18 @@ void FogShader::Draw(const Point &center, double zoom, const PlayerInfo &player)
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
+	// The fog covers the whole screen. Find where the screen's corner is in
+	// the mask, given that pixel (x, y) is centered on the map position
+	// origin + GRID * (x, y). Anything beyond the edge of the mask uses the
+	// edge value, which is completely dark.
+	Point topLeft = Point(Screen::Left(), Screen::Top()) / zoom - center;
 	GLfloat corner[2] = {
-		static_cast<float>((left - .5f * GRID * zoom) / (.5f * Screen::Width())),
-		static_cast<float>((top - .5f * GRID * zoom) / (-.5f * Screen::Height()))};
+		static_cast<float>(((topLeft.X() - origin.X()) / GRID + .5) / columns),
+		static_cast<float>(((topLeft.Y() - origin.Y()) / GRID + .5) / rows)};
 	glUniform2fv(cornerI, 1, corner);
 	GLfloat dimensions[2] = {
-		static_cast<float>(GRID * zoom * (columns + 1.f) / (.5f * Screen::Width())),
-		static_cast<float>(GRID * zoom * (rows + 1.f) / (-.5f * Screen::Height()))};
+		static_cast<float>(Screen::Width() / (zoom * GRID * columns)),
+		static_cast<float>(Screen::Height() / (zoom * GRID * rows))};
 	glUniform2fv(dimensionsI, 1, dimensions);
 	
 	// Call the shader program to draw the image.
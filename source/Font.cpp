@@ -30,24 +30,20 @@ namespace {
 	const char *vertexCode =
 		// "scale" maps pixel coordinates to GL coordinates (-1 to 1).
 		"uniform vec2 scale;\n"
-		// The (x, y) coordinates of the top left corner of the glyph.
+		// The (x, y) coordinates of the top left corner of the string.
 		"uniform vec2 position;\n"
-		// The glyph to draw. (ASCII value - 32).
-		"uniform int glyph;\n"
-		// Aspect ratio of rendered glyph (unity by default).
-		"uniform float aspect = 1.f;\n"
 		
 		// Inputs from the VBO.
 		"in vec2 vert;\n"
-		"in vec2 corner;\n"
+		"in vec2 vertTexCoord;\n"
 		
 		// Output to the fragment shader.
 		"out vec2 texCoord;\n"
 		
-		// Pick the proper glyph out of the texture.
+		// The glyphs have already been laid out; just move them into place.
 		"void main() {\n"
-		"  texCoord = vec2((glyph + corner.x) / 98.f, corner.y);\n"
-		"  gl_Position = vec4((aspect * vert.x + position.x) * scale.x, (vert.y + position.y) * scale.y, 0, 1);\n"
+		"  texCoord = vertTexCoord;\n"
+		"  gl_Position = vec4((vert + position) * scale, 0, 1);\n"
 		"}\n";
 	
 	const char *fragmentCode =
@@ -67,13 +63,21 @@ namespace {
 		"}\n";
 	
 	const int KERN = 2;
+	
+	// Each vertex is four floats.
+	const GLsizeiptr VERTEX_SIZE = 4 * sizeof(float);
+	const GLsizeiptr MIN_BUFFER_SIZE = 1 << 16;
+	// If this many different strings have been drawn, forget their layouts
+	// and start over, so strings that change every frame do not fill memory.
+	const size_t MAX_LAYOUTS = 4096;
 }
 
 
 
 Font::Font()
-	: texture(0), vao(0), vbo(0), colorI(0), scaleI(0), glyphI(0), aspectI(0),
-	  positionI(0), height(0), space(0), screenWidth(0), screenHeight(0)
+	: texture(0), vao(0), vbo(0), colorI(0), scaleI(0), positionI(0), height(0), space(0),
+	  glyphWidth(0.f), glyphHeight(0.f), screenWidth(0), screenHeight(0),
+	  buffer(MIN_BUFFER_SIZE), layoutUnderlines(false)
 {
 }
 
@@ -110,9 +114,14 @@ void Font::Draw(const string &str, const Point &point, const Color &color) const
 
 void Font::DrawAliased(const string &str, double x, double y, const Color &color) const
 {
+	const vector<float> &vertices = Layout(str);
+	if(vertices.empty())
+		return;
+	
 	glUseProgram(shader.Object());
 	glBindTexture(GL_TEXTURE_2D, texture);
 	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 	
 	glUniform4fv(colorI, 1, color.Get());
 	
@@ -128,51 +137,14 @@ void Font::DrawAliased(const string &str, double x, double y, const Color &color
 	GLfloat textPos[2] = {
 		static_cast<float>(x - 1.),
 		static_cast<float>(y)};
-	int previous = 0;
-	bool isAfterSpace = true;
-	bool underlineChar = false;
-	const int underscoreGlyph = max(0, min(GLYPHS - 1, '_' - 32));
+	glUniform2fv(positionI, 1, textPos);
 	
-	for(char c : str)
-	{
-		if(c == '_')
-		{
-			underlineChar = showUnderlines;
-			continue;
-		}
-		
-		int glyph = Glyph(c, isAfterSpace);
-		if(c != '"' && c != '\'')
-			isAfterSpace = !glyph;
-		if(!glyph)
-		{
-			textPos[0] += space;
-			continue;
-		}
-		
-		glUniform1i(glyphI, glyph);
-		glUniform1f(aspectI, 1.f);
-		
-		textPos[0] += advance[previous * GLYPHS + glyph] + KERN;
-		glUniform2fv(positionI, 1, textPos);
-		
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		
-		if(underlineChar)
-		{
-			glUniform1i(glyphI, underscoreGlyph);
-			glUniform1f(aspectI, static_cast<float>(advance[glyph * GLYPHS] + KERN)
-				/ (advance[underscoreGlyph * GLYPHS] + KERN));
-			
-			glUniform2fv(positionI, 1, textPos);
-			
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-			underlineChar = false;
-		}
-		
-		previous = glyph;
-	}
+	// Upload the vertex data and draw all the glyphs.
+	GLsizeiptr size = sizeof(float) * vertices.size();
+	GLsizeiptr offset = buffer.Upload(vertices.data(), size);
+	glDrawArrays(GL_TRIANGLES, offset / VERTEX_SIZE, size / VERTEX_SIZE);
 	
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 	glUseProgram(0);
 }
@@ -357,6 +329,82 @@ int Font::Glyph(char c, bool isAfterSpace)
 
 
 
+// Get the vertex data for drawing the given string, with the top left
+// corner of the first glyph at (0, 0).
+const vector<float> &Font::Layout(const string &str) const
+{
+	// Turning underlines on or off changes how every string is drawn.
+	if(layoutUnderlines != showUnderlines)
+	{
+		layouts.clear();
+		layoutUnderlines = showUnderlines;
+	}
+	auto it = layouts.find(str);
+	if(it != layouts.end())
+		return it->second;
+	
+	if(layouts.size() >= MAX_LAYOUTS)
+		layouts.clear();
+	vector<float> &vertices = layouts[str];
+	
+	// Add a glyph, stretched horizontally by the given factor, at the given
+	// x position.
+	auto addGlyph = [this, &vertices](int glyph, float x, float aspect)
+	{
+		float left = x;
+		float right = x + aspect * glyphWidth;
+		float s0 = glyph / static_cast<float>(GLYPHS);
+		float s1 = (glyph + 1) / static_cast<float>(GLYPHS);
+		const float quad[24] = {
+			left, 0.f, s0, 0.f,
+			left, glyphHeight, s0, 1.f,
+			right, 0.f, s1, 0.f,
+			right, 0.f, s1, 0.f,
+			left, glyphHeight, s0, 1.f,
+			right, glyphHeight, s1, 1.f};
+		vertices.insert(vertices.end(), quad, quad + 24);
+	};
+	
+	float x = 0.f;
+	int previous = 0;
+	bool isAfterSpace = true;
+	bool underlineChar = false;
+	const int underscoreGlyph = max(0, min(GLYPHS - 1, '_' - 32));
+	
+	for(char c : str)
+	{
+		if(c == '_')
+		{
+			underlineChar = showUnderlines;
+			continue;
+		}
+		
+		int glyph = Glyph(c, isAfterSpace);
+		if(c != '"' && c != '\'')
+			isAfterSpace = !glyph;
+		if(!glyph)
+		{
+			x += space;
+			continue;
+		}
+		
+		x += advance[previous * GLYPHS + glyph] + KERN;
+		addGlyph(glyph, x, 1.f);
+		
+		if(underlineChar)
+		{
+			addGlyph(underscoreGlyph, x, static_cast<float>(advance[glyph * GLYPHS] + KERN)
+				/ (advance[underscoreGlyph * GLYPHS] + KERN));
+			underlineChar = false;
+		}
+		
+		previous = glyph;
+	}
+	return vertices;
+}
+
+
+
 void Font::LoadTexture(ImageBuffer &image)
 {
 	glGenTextures(1, &texture);
@@ -437,36 +485,30 @@ void Font::CalculateAdvances(ImageBuffer &image)
 
 void Font::SetUpShader(float glyphW, float glyphH)
 {
-	glyphW *= .5f;
-	glyphH *= .5f;
+	glyphWidth = glyphW * .5f;
+	glyphHeight = glyphH * .5f;
 	
 	shader = Shader(vertexCode, fragmentCode);
 	glUseProgram(shader.Object());
 	glUniform1i(shader.Uniform("tex"), 0);
 	glUseProgram(0);
 	
-	// Create the VAO and VBO.
+	// Create the VAO and VBO. The vertex data is uploaded when each string is
+	// drawn.
 	glGenVertexArrays(1, &vao);
 	glBindVertexArray(vao);
 	
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	
-	GLfloat vertices[] = {
-		   0.f,    0.f, 0.f, 0.f,
-		   0.f, glyphH, 0.f, 1.f,
-		glyphW,    0.f, 1.f, 0.f,
-		glyphW, glyphH, 1.f, 1.f
-	};
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	buffer.Reset();
 	
 	// connect the xy to the "vert" attribute of the vertex shader
 	glEnableVertexAttribArray(shader.Attrib("vert"));
-	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE, nullptr);
 	
-	glEnableVertexAttribArray(shader.Attrib("corner"));
-	glVertexAttribPointer(shader.Attrib("corner"), 2, GL_FLOAT, GL_FALSE,
-		4 * sizeof(GLfloat), (const GLvoid*)(2 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(shader.Attrib("vertTexCoord"));
+	glVertexAttribPointer(shader.Attrib("vertTexCoord"), 2, GL_FLOAT, GL_FALSE,
+		VERTEX_SIZE, (const GLvoid*)(2 * sizeof(GLfloat)));
 	
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
@@ -474,13 +516,12 @@ void Font::SetUpShader(float glyphW, float glyphH)
 	// We must update the screen size next time we draw.
 	screenWidth = 0;
 	screenHeight = 0;
+	layouts.clear();
 	
 	// The texture always comes from texture unit 0.
 	glUniform1i(shader.Uniform("tex"), 0);
 
 	colorI = shader.Uniform("color");
 	scaleI = shader.Uniform("scale");
-	glyphI = shader.Uniform("glyph");
-	aspectI = shader.Uniform("aspect");
 	positionI = shader.Uniform("position");
 }
@@ -14,10 +14,13 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #define FONT_H_
 
 #include "Shader.h"
+#include "StreamBuffer.h"
 
 #include "gl_header.h"
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class Color;
 class ImageBuffer;
@@ -28,7 +31,9 @@ class Point;
 // Class for drawing text in OpenGL. Each font is based on a single image with
 // glyphs for each character in ASCII order (not counting control characters).
 // The kerning between characters is automatically adjusted to look good. At the
-// moment only plain ASCII characters are supported, not Unicode.
+// moment only plain ASCII characters are supported, not Unicode. Each string is
+// drawn with a single draw command, and the layout of recently drawn strings is
+// cached so that labels that are drawn every frame need not be laid out again.
 class Font {
 public:
 	Font();
@@ -54,6 +59,9 @@ public:
 	
 private:
 	static int Glyph(char c, bool isAfterSpace);
+	// Get the vertex data for drawing the given string, with the top left
+	// corner of the first glyph at (0, 0).
+	const std::vector<float> &Layout(const std::string &str) const;
 	void LoadTexture(ImageBuffer &image);
 	void CalculateAdvances(ImageBuffer &image);
 	void SetUpShader(float glyphW, float glyphH);
@@ -67,15 +75,23 @@ private:
 	
 	GLint colorI;
 	GLint scaleI;
-	GLint glyphI;
-	GLint aspectI;
 	GLint positionI;
 	
 	int height;
 	int space;
+	float glyphWidth;
+	float glyphHeight;
 	mutable int screenWidth;
 	mutable int screenHeight;
 	
+	// The vertex data of each string is streamed into the VBO.
+	mutable StreamBuffer buffer;
+	// Each glyph is two triangles, and each vertex has four attributes: (x, y)
+	// position in pixels and (s, t) texture coordinates. The cached layouts
+	// depend on whether underlines are being shown.
+	mutable std::unordered_map<std::string, std::vector<float>> layouts;
+	mutable bool layoutUnderlines;
+	
 	static const int GLYPHS = 98;
 	int advance[GLYPHS * GLYPHS];
 };
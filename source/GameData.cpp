@@ -54,14 +54,30 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "SpriteShader.h"
 #include "StarField.h"
 #include "StartConditions.h"
+#include "StellarObject.h"
 #include "System.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <set>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 class Sprite;
 
 using namespace std;
@@ -87,14 +103,6 @@ namespace {
 	Set<Sale<Ship>> shipSales;
 	Set<Sale<Outfit>> outfitSales;
 	
-	Set<Fleet> defaultFleets;
-	Set<Government> defaultGovernments;
-	Set<Planet> defaultPlanets;
-	Set<System> defaultSystems;
-	Set<Galaxy> defaultGalaxies;
-	Set<Sale<Ship>> defaultShipSales;
-	Set<Sale<Outfit>> defaultOutfitSales;
-	
 	Politics politics;
 	StartConditions startConditions;
 	
@@ -116,10 +124,164 @@ namespace {
 	SpriteQueue spriteQueue;
 	
 	vector<string> sources;
+	// Sprites whose textures are only loaded when they are needed, and the
+	// images to load them from. Landscapes are not read at all until they are
+	// needed; other lazy sprites are read once at startup for their sizes and
+	// collision masks, but their textures are not created.
 	map<const Sprite *, shared_ptr<ImageSet>> deferred;
+	// Sprites that are being loaded at startup. If one of them is drawn before
+	// it has been loaded, it is moved ahead of the others in the queue.
+	vector<const Sprite *> queuedSprites;
+	// Image directories whose sprites are loaded lazily, besides landscapes.
+	vector<string> lazyCategories;
+	// Lazy sprites that are loaded (or being loaded), and the last frame in
+	// which each one was used. If their textures take up more memory than the
+	// budget, the ones that have gone unused the longest are unloaded.
 	map<const Sprite *, int> preloaded;
+	int spriteFrame = 0;
+	size_t textureBudget = 256 << 20;
+	// Don't unload a sprite that was used this recently, because it may still
+	// be in the list of things that are being drawn.
+	const int MIN_UNUSED_FRAMES = 60;
+	// Lazy sprites can only be loaded again once the sprites are all loaded,
+	// because until then they may still be waiting in the sprite queue.
+	bool spritesReady = false;
+	// Remember whether any sprites were waiting to be uploaded on the last
+	// frame, so that the frame where the last of them is uploaded is redrawn.
+	bool wasUploading = false;
 	
 	const Government *playerGovernment = nullptr;
+	
+	// In debug mode, remember when each data file was last modified, so that
+	// data files that are edited while the game is running can be reloaded.
+	// Some file systems only store the time in whole seconds, so the size of
+	// the file is compared as well.
+	typedef tuple<time_t, long, uint64_t> DataStamp;
+	map<string, DataStamp> dataTimestamps;
+	// File descriptor used to watch the data directories for changes, and the
+	// directory that each watch belongs to.
+	int watchDescriptor = -1;
+	map<int, string> watchedDirectories;
+	// Files that the watch saw being written are reloaded even if their time
+	// stamp and size happen to be the same as before.
+	set<string> writtenPaths;
+	// Data files are only reloaded once it is safe to do so, i.e. when the
+	// Engine's calculation thread is not running.
+	bool isReloadRequested = false;
+	
+	// Load-time profiling, enabled by the "--profile-load" command line flag.
+	bool profileLoad = false;
+	bool profileReported = false;
+	chrono::steady_clock::time_point spriteQueueStart;
+	// Each load phase, in the order it happened, and how long it took.
+	vector<pair<string, double>> loadPhases;
+	// For each data file: the total time, the parsing time, and the path.
+	vector<pair<pair<double, double>, string>> fileTimes;
+	size_t dataBytes = 0;
+	size_t imageBytes = 0;
+	size_t nodeCount = 0;
+	size_t tokenCount = 0;
+	// How many of the slowest data files to list in the report.
+	const size_t SLOWEST_FILES = 10;
+	
+	double Seconds(chrono::steady_clock::time_point start)
+	{
+		return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+	
+	// Start timing a phase of the load. Call EndPhase() to record the result.
+	chrono::steady_clock::time_point BeginPhase()
+	{
+		return chrono::steady_clock::now();
+	}
+	
+	void EndPhase(const string &name, chrono::steady_clock::time_point start)
+	{
+		if(profileLoad)
+			loadPhases.emplace_back(name, Seconds(start));
+	}
+	
+	void CountNodes(const DataNode &node)
+	{
+		++nodeCount;
+		tokenCount += node.Size();
+		for(const DataNode &child : node)
+			CountNodes(child);
+	}
+	
+	// Decide which priority class a sprite should be loaded in, based on its
+	// name. Sprites in the player's current system are moved up separately,
+	// once the player has been loaded.
+	SpriteQueue::Priority SpritePriority(const string &name)
+	{
+		static const vector<string> INTERFACE = {"ui/", "icon/", "font/", "label/", "_menu/"};
+		static const vector<string> SHIPS = {"ship/", "outfit/", "hardpoint/", "effect/", "projectile/"};
+		for(const string &prefix : INTERFACE)
+			if(!name.compare(0, prefix.length(), prefix))
+				return SpriteQueue::INTERFACE;
+		for(const string &prefix : SHIPS)
+			if(!name.compare(0, prefix.length(), prefix))
+				return SpriteQueue::SHIPS;
+		return SpriteQueue::OTHER;
+	}
+	
+	// Check whether the sprite with the given name is in one of the categories
+	// that should be loaded lazily.
+	bool IsLazy(const string &name)
+	{
+		for(const string &prefix : lazyCategories)
+			if(!name.compare(0, prefix.length(), prefix))
+				return true;
+		return false;
+	}
+	
+	// Get the peak resident set size of this process, in bytes, or zero if
+	// that information is not available on this platform.
+	size_t PeakMemory()
+	{
+#ifndef _WIN32
+		rusage usage;
+		if(getrusage(RUSAGE_SELF, &usage))
+			return 0;
+#ifdef __APPLE__
+		return usage.ru_maxrss;
+#else
+		return usage.ru_maxrss * size_t(1024);
+#endif
+#else
+		return 0;
+#endif
+	}
+	
+	// Get the modification time and size of the given data file. The time
+	// includes nanoseconds where the platform provides them.
+	DataStamp GetDataStamp(const string &path)
+	{
+#ifdef __linux__
+		struct stat buf;
+		if(stat(path.c_str(), &buf))
+			return DataStamp(0, 0, 0);
+		return DataStamp(buf.st_mtim.tv_sec, buf.st_mtim.tv_nsec, buf.st_size);
+#else
+		return DataStamp(Files::Timestamp(path), 0, Files::Size(path));
+#endif
+	}
+	
+#ifdef __linux__
+	// Watch the given data directory and all its subdirectories for files that
+	// are written or moved into them. New subdirectories are watched as well,
+	// as soon as they are seen.
+	void WatchDirectory(const string &directory)
+	{
+		int watch = inotify_add_watch(watchDescriptor, directory.c_str(),
+			IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+		if(watch < 0)
+			return;
+		watchedDirectories[watch] = directory;
+		for(const string &child : Files::ListDirectories(directory))
+			WatchDirectory(child);
+	}
+#endif
 }
 
 
@@ -140,65 +302,88 @@ void GameData::BeginLoad(const char * const *argv)
 				printWeapons = true;
 			if(arg == "-d" || arg == "--debug")
 				debugMode = true;
+			if(arg == "--profile-load")
+				profileLoad = true;
+			if(arg == "--texture-budget" && it[1])
+				textureBudget = static_cast<size_t>(max(0, atoi(*++it))) << 20;
+			if(arg == "--lazy-sprites" && it[1])
+			{
+				string list = *++it;
+				for(size_t start = 0; start < list.length(); )
+				{
+					size_t end = min(list.find(',', start), list.length());
+					if(end > start)
+						lazyCategories.push_back(list.substr(start, end - start) + '/');
+					start = end + 1;
+				}
+			}
 			continue;
 		}
 	}
 	Files::Init(argv);
 	
 	// Initialize the list of "source" folders based on any active plugins.
+	auto start = BeginPhase();
+	spriteQueueStart = start;
 	LoadSources();
+	EndPhase("LoadSources", start);
 	
 	// Now, read all the images in all the path directories. For each unique
 	// name, only remember one instance, letting things on the higher priority
-	// paths override the default images.
-	map<string, shared_ptr<ImageSet>> images = FindImages();
-	
-	// From the name, strip out any frame number, plus the extension.
-	for(const auto &it : images)
-	{
-		// This should never happen, but just in case:
-		if(!it.second)
-			continue;
-		
-		// Check that the image set is complete.
-		it.second->Check();
-		// For landscapes, remember all the source files but don't load them yet.
-		if(ImageSet::IsDeferred(it.first))
-			deferred[SpriteSet::Get(it.first)] = it.second;
-		else
-			spriteQueue.Add(it.second);
-	}
+	// paths override the default images. Each sprite is queued for loading as
+	// soon as all of its frames have been found.
+	start = BeginPhase();
+	FindImages();
+	EndPhase("FindImages", start);
 	
 	// Generate a catalog of music files.
+	start = BeginPhase();
 	Music::Init(sources);
+	EndPhase("Music::Init", start);
 	
+	// Find the data files in all the sources at once.
+	vector<string> dataDirectories;
 	for(const string &source : sources)
+		dataDirectories.push_back(source + "data/");
+	start = BeginPhase();
+	vector<vector<string>> dataFiles = Files::RecursiveList(dataDirectories);
+	EndPhase("data file scan", start);
+	
+	for(size_t i = 0; i < sources.size(); ++i)
 	{
 		// Iterate through the paths starting with the last directory given. That
 		// is, things in folders near the start of the path have the ability to
 		// override things in folders later in the path.
-		vector<string> dataFiles = Files::RecursiveList(source + "data/");
-		for(const string &path : dataFiles)
+		start = BeginPhase();
+		for(const string &path : dataFiles[i])
 			LoadFile(path, debugMode);
+		EndPhase("data: " + sources[i], start);
 	}
 	
 	// Now that all the stars are loaded, update the neighbor lists.
+	start = BeginPhase();
 	UpdateNeighbors();
+	EndPhase("UpdateNeighbors", start);
 	// And, update the ships with the outfits we've now finished loading.
+	start = BeginPhase();
 	for(auto &it : ships)
 		it.second.FinishLoading(true);
+	EndPhase("Ship::FinishLoading", start);
 	for(auto &it : persons)
 		it.second.FinishLoading();
 	startConditions.FinishLoading();
 	
-	// Store the current state, to revert back to later.
-	defaultFleets = fleets;
-	defaultGovernments = governments;
-	defaultPlanets = planets;
-	defaultSystems = systems;
-	defaultGalaxies = galaxies;
-	defaultShipSales = shipSales;
-	defaultOutfitSales = outfitSales;
+	// Store the current state, to revert back to later. Only the objects that
+	// events actually modify will be saved.
+	start = BeginPhase();
+	fleets.Snapshot();
+	governments.Snapshot();
+	planets.Snapshot();
+	systems.Snapshot();
+	galaxies.Snapshot();
+	shipSales.Snapshot();
+	outfitSales.Snapshot();
+	EndPhase("default snapshots", start);
 	playerGovernment = governments.Get("Escort");
 	
 	politics.Reset();
@@ -279,54 +464,140 @@ void GameData::LoadShaders()
 
 double GameData::Progress()
 {
-	return min(spriteQueue.Progress(), Audio::Progress());
+	double spriteProgress = spriteQueue.Progress();
+	if(spriteProgress == 1.)
+		spritesReady = true;
+	if(profileLoad && !profileReported && spriteProgress == 1.)
+		PrintLoadProfile();
+	return min(spriteProgress, Audio::Progress());
 }
 
 
 
-// Begin loading a sprite that was previously deferred. Currently this is
-// done with all landscapes to speed up the program's startup.
+// Begin loading a sprite that was previously deferred, because it is about
+// to be needed. This is done with all landscapes to speed up the program's
+// startup, and with any other sprites that are loaded lazily.
 void GameData::Preload(const Sprite *sprite)
 {
 	// Make sure this sprite actually is one that uses deferred loading.
 	auto dit = deferred.find(sprite);
 	if(!sprite || dit == deferred.end())
 		return;
+	// Lazy sprites other than landscapes may still be in the queue from the
+	// first time they were loaded.
+	if(!spritesReady && !ImageSet::IsDeferred(sprite->Name()))
+		return;
 	
-	// If this sprite is one of the currently loaded ones, there is no need to
-	// load it again. But, make note of the fact that it is the most recently
-	// asked-for sprite.
-	map<const Sprite *, int>::iterator pit = preloaded.find(sprite);
+	// If this sprite is already loaded, there is no need to load it again.
+	// But, make note of the fact that it is the most recently used sprite.
+	auto pit = preloaded.find(sprite);
 	if(pit != preloaded.end())
 	{
-		for(pair<const Sprite * const, int> &it : preloaded)
-			if(it.second < pit->second)
-				++it.second;
-		
-		pit->second = 0;
+		pit->second = spriteFrame;
 		return;
 	}
 	
-	// This sprite is not currently preloaded. Check to see whether we already
-	// have the maximum number of sprites loaded, in which case the oldest one
-	// must be unloaded to make room for this one.
-	const string &name = sprite->Name();
-	pit = preloaded.begin();
-	while(pit != preloaded.end())
+	// Now, load all the files for this sprite. It is about to be needed, so
+	// load it before anything that is not in the current system.
+	preloaded[sprite] = spriteFrame;
+	spriteQueue.Add(dit->second, SpriteQueue::SYSTEM);
+}
+
+
+
+// Load any lazy sprites that were drawn without being loaded, and unload
+// the ones that have not been used recently if their textures take up more
+// memory than the budget allows. This should be called once per frame. The
+// return value is true if any sprites may have been uploaded, which means
+// anything that is drawing them must be redrawn.
+bool GameData::UpdateLazySprites()
+{
+	++spriteFrame;
+	// Upload any sprites that have been read in the meantime.
+	bool isUploading = (spriteQueue.Progress() < 1.);
+	if(!isUploading)
+		spritesReady = true;
+	bool hasChanged = (isUploading || wasUploading);
+	wasUploading = isUploading;
+	
+	// Anything that is drawn before it has been loaded is needed right away.
+	if(!spritesReady)
 	{
-		++pit->second;
-		if(pit->second >= 20)
+		for(const Sprite *sprite : queuedSprites)
+			if(!sprite->IsLoaded() && sprite->WasUsed())
+				Prioritize(sprite);
+	}
+	else if(!queuedSprites.empty())
+		vector<const Sprite *>().swap(queuedSprites);
+	
+	size_t textureBytes = 0;
+	for(const auto &it : deferred)
+	{
+		const Sprite *sprite = it.first;
+		bool wasUsed = sprite->WasUsed();
+		auto pit = preloaded.find(sprite);
+		if(pit != preloaded.end())
 		{
-			spriteQueue.Unload(name);
-			pit = preloaded.erase(pit);
+			if(wasUsed)
+				pit->second = spriteFrame;
+			textureBytes += sprite->TextureBytes();
 		}
-		else
-			++pit;
+		else if(wasUsed)
+			Preload(sprite);
 	}
+	if(textureBytes <= textureBudget)
+		return hasChanged;
+	
+	// Find all the sprites that can be unloaded, starting with the one that
+	// has gone unused the longest. Sprites that are still being loaded cannot
+	// be unloaded yet.
+	vector<pair<int, const Sprite *>> unused;
+	for(const auto &it : preloaded)
+		if(it.second < spriteFrame - MIN_UNUSED_FRAMES && it.first->IsLoaded())
+			unused.emplace_back(it.second, it.first);
+	sort(unused.begin(), unused.end());
 	
-	// Now, load all the files for this sprite.
-	preloaded[sprite] = 0;
-	spriteQueue.Add(dit->second);
+	for(const auto &it : unused)
+	{
+		if(textureBytes <= textureBudget)
+			break;
+		
+		textureBytes -= it.second->TextureBytes();
+		spriteQueue.Unload(it.second->Name());
+		preloaded.erase(it.second);
+	}
+	return hasChanged;
+}
+
+
+
+// If the given sprite has not been loaded yet, load it before any sprites
+// that are not as urgently needed.
+void GameData::Prioritize(const Sprite *sprite)
+{
+	if(sprite)
+		spriteQueue.Prioritize(sprite->Name(), SpriteQueue::SYSTEM);
+}
+
+
+
+// Do the same for all the sprites that will be visible in the given system:
+// its stars, planets, asteroids, and background haze.
+void GameData::Prioritize(const System *system)
+{
+	if(!system)
+		return;
+	
+	for(const StellarObject &object : system->Objects())
+		Prioritize(object.GetSprite());
+	for(const System::Asteroid &asteroid : system->Asteroids())
+	{
+		if(asteroid.Type())
+			Prioritize(asteroid.Type()->GetSprite());
+		else
+			Prioritize(SpriteSet::Get("asteroid/" + asteroid.Name() + "/spin"));
+	}
+	Prioritize(system->Haze());
 }
 
 
@@ -334,6 +605,154 @@ void GameData::Preload(const Sprite *sprite)
 void GameData::FinishLoading()
 {
 	spriteQueue.Finish();
+	spritesReady = true;
+	if(profileLoad && !profileReported)
+		PrintLoadProfile();
+}
+
+
+
+// Reload any data files that have been added or modified since they were
+// loaded (debug mode only). The universe is reverted to its default state
+// first, and the modified state becomes the new default, so the caller must
+// re-apply the changes made by any events afterwards. This must not be called
+// while the Engine's calculation thread is running.
+int GameData::ReloadChangedData()
+{
+	isReloadRequested = false;
+	
+	vector<string> changed;
+	for(const string &source : sources)
+		for(const string &path : Files::RecursiveList(source + "data/"))
+		{
+			if(path.length() < 4 || path.compare(path.length() - 4, 4, ".txt"))
+				continue;
+			
+			DataStamp stamp = GetDataStamp(path);
+			auto it = dataTimestamps.find(path);
+			if(it == dataTimestamps.end() || it->second != stamp || writtenPaths.count(path))
+			{
+				dataTimestamps[path] = stamp;
+				changed.push_back(path);
+			}
+		}
+	writtenPaths.clear();
+	if(changed.empty())
+		return 0;
+	
+	fleets.Revert();
+	governments.Revert();
+	planets.Revert();
+	systems.Revert();
+	galaxies.Revert();
+	shipSales.Revert();
+	outfitSales.Revert();
+	
+	// Remember which ships and outfits are defined in the files being reloaded.
+	set<string> shipNames;
+	set<string> outfitNames;
+	for(const string &path : changed)
+	{
+		Files::LogError("Reloading: " + path);
+		DataFile data(path);
+		for(const DataNode &node : data)
+		{
+			if(node.Token(0) == "ship" && node.Size() >= 2)
+				shipNames.insert(node.Token(node.Size() > 2 ? 2 : 1));
+			else if(node.Token(0) == "outfit" && node.Size() >= 2)
+				outfitNames.insert(node.Token(1));
+		}
+		LoadData(data);
+	}
+	
+	UpdateNeighbors();
+	// Only the ships that were reloaded, or that use or are based on an outfit
+	// or ship that was reloaded, need to be updated.
+	for(auto &it : ships)
+	{
+		bool isAffected = shipNames.count(it.first) || shipNames.count(it.second.ModelName());
+		for(auto oit = it.second.Outfits().begin(); !isAffected && oit != it.second.Outfits().end(); ++oit)
+			isAffected = outfitNames.count(oit->first->Name());
+		if(isAffected)
+			it.second.FinishLoading(true);
+	}
+	
+	// The reloaded state is the new default state of the universe.
+	fleets.Snapshot();
+	governments.Snapshot();
+	planets.Snapshot();
+	systems.Snapshot();
+	galaxies.Snapshot();
+	shipSales.Snapshot();
+	outfitSales.Snapshot();
+	
+	return changed.size();
+}
+
+
+
+// Begin watching the data directories for changes, on platforms where that is
+// supported. This is only done in debug mode.
+void GameData::WatchData()
+{
+#ifdef __linux__
+	if(watchDescriptor >= 0)
+		return;
+	
+	watchDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(watchDescriptor < 0)
+		return;
+	
+	for(const string &source : sources)
+		if(Files::Exists(source + "data"))
+			WatchDirectory(source + "data/");
+#endif
+}
+
+
+
+// Check whether any watched data file has changed since this was last called.
+bool GameData::HasDataChanged()
+{
+#ifdef __linux__
+	if(watchDescriptor >= 0)
+	{
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length = 0;
+		while((length = read(watchDescriptor, buffer, sizeof(buffer))) > 0)
+			for(const char *it = buffer; it < buffer + length; )
+			{
+				const inotify_event *event = reinterpret_cast<const inotify_event *>(it);
+				it += sizeof(inotify_event) + event->len;
+				
+				auto dit = watchedDirectories.find(event->wd);
+				if(dit == watchedDirectories.end() || !event->len)
+					continue;
+				
+				// New directories must be watched too. Any files that were
+				// written to them before the watch began are found when the
+				// data directories are scanned for changes.
+				string path = dit->second + event->name;
+				if(event->mask & IN_ISDIR)
+					WatchDirectory(path + '/');
+				else if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+					writtenPaths.insert(path);
+				else
+					continue;
+				isReloadRequested = true;
+			}
+	}
+#endif
+	return isReloadRequested;
+}
+
+
+
+// Ask for the data files to be checked for changes the next time that it is
+// safe to reload them (e.g. because the player pressed the reload key).
+void GameData::RequestReload()
+{
+	isReloadRequested = true;
 }
 
 
@@ -349,16 +768,27 @@ const vector<string> &GameData::Sources()
 // Revert any changes that have been made to the universe.
 void GameData::Revert()
 {
-	fleets.Revert(defaultFleets);
-	governments.Revert(defaultGovernments);
-	planets.Revert(defaultPlanets);
-	systems.Revert(defaultSystems);
-	galaxies.Revert(defaultGalaxies);
-	shipSales.Revert(defaultShipSales);
-	outfitSales.Revert(defaultOutfitSales);
+	fleets.Revert();
+	governments.Revert();
+	planets.Revert();
+	galaxies.Revert();
+	shipSales.Revert();
+	outfitSales.Revert();
+	// If any system was changed, the neighbor lists of the systems that were
+	// not changed may still refer to it, so they must all be recalculated.
+	if(systems.Revert())
+		UpdateNeighbors();
 	for(auto &it : persons)
 		it.second.Restore();
 	
+	// The economy and the planets' defense fleets are not recorded as changes,
+	// so reset them directly.
+	for(auto &it : systems)
+		for(const Trade::Commodity &commodity : trade.Commodities())
+			it.second.SetSupply(commodity.name, 0.);
+	for(const auto &it : planets)
+		it.second.ResetDefense();
+	
 	politics.Reset();
 	purchases.clear();
 }
@@ -386,7 +816,7 @@ void GameData::ReadEconomy(const DataNode &node)
 		{
 			for(const DataNode &grand : child)
 				if(grand.Size() >= 3 && grand.Value(2))
-					purchases[systems.Get(grand.Token(0))][grand.Token(1)] += grand.Value(2);
+					purchases[GameData::Systems().Get(grand.Token(0))][grand.Token(1)] += grand.Value(2);
 		}
 		else if(child.Token(0) == "system")
 		{
@@ -396,7 +826,9 @@ void GameData::ReadEconomy(const DataNode &node)
 		}
 		else
 		{
-			System &system = *systems.Get(child.Token(0));
+			// The economy is reset directly when reverting, so there is no need
+			// to record this as a change to the system.
+			System &system = const_cast<System &>(*GameData::Systems().Get(child.Token(0)));
 			
 			int index = 0;
 			for(const string &commodity : headings)
@@ -855,7 +1287,7 @@ void GameData::LoadSources()
 		else if(Files::Exists(*it + "icon@2x.jpg"))
 			icon->Add(*it + "icon@2x.jpg");
 		
-		spriteQueue.Add(icon);
+		spriteQueue.Add(icon, SpriteQueue::INTERFACE);
 	}
 }
 
@@ -867,10 +1299,31 @@ void GameData::LoadFile(const string &path, bool debugMode)
 	if(path.length() < 4 || path.compare(path.length() - 4, 4, ".txt"))
 		return;
 	
+	auto start = BeginPhase();
 	DataFile data(path);
 	if(debugMode)
+	{
 		Files::LogError("Parsing: " + path);
+		dataTimestamps[path] = GetDataStamp(path);
+	}
+	double parseTime = (profileLoad ? Seconds(start) : 0.);
+	
+	LoadData(data);
 	
+	if(profileLoad)
+	{
+		fileTimes.emplace_back(make_pair(Seconds(start), parseTime), path);
+		dataBytes += Files::Size(path);
+		for(const DataNode &node : data)
+			CountNodes(node);
+	}
+}
+
+
+
+// Apply all the root nodes of the given data file to the game data.
+void GameData::LoadData(const DataFile &data)
+{
 	for(const DataNode &node : data)
 	{
 		const string &key = node.Token(0);
@@ -968,29 +1421,160 @@ void GameData::LoadFile(const string &path, bool debugMode)
 
 
 
-map<string, shared_ptr<ImageSet>> GameData::FindImages()
+// Find all the images in all the sources. To avoid waiting for the whole scan
+// to finish, each directory's sprites are queued for loading as soon as that
+// directory has been scanned in every source that has it.
+void GameData::FindImages()
 {
-	map<string, shared_ptr<ImageSet>> images;
+	// All names will only include the portion of the path that comes after
+	// each source's image directory.
+	vector<string> roots;
 	for(const string &source : sources)
+		roots.push_back(source + "images/");
+	
+	// For each source, keep track of which directories (relative to the image
+	// directory) have been scanned, and which ones are known to exist.
+	vector<set<string>> scanned(roots.size());
+	vector<set<string>> known(roots.size());
+	// For each directory that is not complete yet, the images found in it so
+	// far in each of the sources.
+	map<string, vector<vector<string>>> found;
+	
+	// Check whether the given directory has been scanned in the given source,
+	// or whether that source is known not to have it at all.
+	auto isDone = [&](const string &directory, size_t source) -> bool
 	{
-		// All names will only include the portion of the path that comes after
-		// this directory prefix.
-		string directoryPath = source + "images/";
-		size_t start = directoryPath.size();
+		if(scanned[source].count(directory))
+			return true;
 		
-		vector<string> imageFiles = Files::RecursiveList(directoryPath);
-		for(const string &path : imageFiles)
+		string child = directory;
+		while(!child.empty())
+		{
+			size_t pos = child.rfind('/', child.length() - 2);
+			string parent = (pos == string::npos ? "" : child.substr(0, pos + 1));
+			if(scanned[source].count(parent))
+				return !known[source].count(child);
+			child = parent;
+		}
+		return false;
+	};
+	
+	Files::RecursiveList(roots, [&](size_t source, const string &directory,
+		const vector<string> &files, const vector<string> &subdirectories)
+	{
+		size_t start = roots[source].length();
+		string relative = directory.substr(start);
+		scanned[source].insert(relative);
+		for(const string &path : subdirectories)
+			known[source].insert(path.substr(start));
+		
+		vector<vector<string>> &paths = found[relative];
+		paths.resize(roots.size());
+		for(const string &path : files)
 			if(ImageSet::IsImage(path))
 			{
-				string name = ImageSet::Name(path.substr(start));
-				
-				shared_ptr<ImageSet> &imageSet = images[name];
-				if(!imageSet)
-					imageSet.reset(new ImageSet(name));
-				imageSet->Add(path);
+				paths[source].push_back(path);
+				if(profileLoad)
+					imageBytes += Files::Size(path);
 			}
-	}
-	return images;
+		
+		auto it = found.begin();
+		while(it != found.end())
+		{
+			bool isComplete = true;
+			for(size_t i = 0; isComplete && i < roots.size(); ++i)
+				isComplete = isDone(it->first, i);
+			if(!isComplete)
+			{
+				++it;
+				continue;
+			}
+			
+			// Add the frames from each source in order, so that the later ones
+			// override the earlier ones.
+			map<string, shared_ptr<ImageSet>> images;
+			for(size_t i = 0; i < roots.size(); ++i)
+				for(const string &path : it->second[i])
+				{
+					string name = ImageSet::Name(path.substr(roots[i].length()));
+					
+					shared_ptr<ImageSet> &imageSet = images[name];
+					if(!imageSet)
+						imageSet.reset(new ImageSet(name));
+					imageSet->Add(path);
+				}
+			
+			for(const auto &iit : images)
+			{
+				// Check that the image set is complete.
+				iit.second->Check();
+				// For landscapes, remember all the source files but don't load them yet.
+				if(ImageSet::IsDeferred(iit.first))
+					deferred[SpriteSet::Get(iit.first)] = iit.second;
+				else
+				{
+					// Other lazy sprites are still read now, to get their sizes
+					// and collision masks.
+					if(IsLazy(iit.first))
+					{
+						iit.second->SetLazy();
+						deferred[SpriteSet::Get(iit.first)] = iit.second;
+					}
+					else
+						queuedSprites.push_back(SpriteSet::Get(iit.first));
+					spriteQueue.Add(iit.second, SpritePriority(iit.first));
+				}
+			}
+			it = found.erase(it);
+		}
+	});
+}
+
+
+
+// Print how long each phase of loading took, plus some statistics about how
+// much data was loaded. This is called once all the sprites are loaded.
+void GameData::PrintLoadProfile()
+{
+	profileReported = true;
+	loadPhases.emplace_back("sprite decode queue (since start of loading)", Seconds(spriteQueueStart));
+	
+	cerr << fixed << setprecision(3);
+	cerr << endl << "Load profile (seconds):" << endl;
+	for(const auto &it : loadPhases)
+		cerr << setw(10) << it.second << "  " << it.first << endl;
+	
+	sort(fileTimes.begin(), fileTimes.end(),
+		[](const pair<pair<double, double>, string> &a, const pair<pair<double, double>, string> &b)
+		{
+			return a.first.first > b.first.first;
+		});
+	if(fileTimes.size() > SLOWEST_FILES)
+		fileTimes.resize(SLOWEST_FILES);
+	cerr << endl << "Slowest data files (total, parsing):" << endl;
+	for(const auto &it : fileTimes)
+		cerr << setw(10) << it.first.first << setw(10) << it.first.second << "  " << it.second << endl;
+	
+	cerr << endl;
+	cerr << "Data bytes read: " << dataBytes << endl;
+	cerr << "Image bytes read: " << imageBytes << endl;
+	cerr << "Data nodes created: " << nodeCount << endl;
+	cerr << "Data tokens created: " << tokenCount << endl;
+	int masksLoaded = 0;
+	int masksGenerated = 0;
+	double maskTimeSaved = 0.;
+	ImageSet::MaskCacheStatistics(&masksLoaded, &masksGenerated, &maskTimeSaved);
+	cerr << "Collision masks: " << masksLoaded << " sprites cached, " << masksGenerated
+		<< " generated, " << maskTimeSaved << " seconds of generation (all threads) saved" << endl;
+	size_t peak = PeakMemory();
+	if(peak)
+		cerr << "Peak resident memory: " << peak / (1024 * 1024) << " MB" << endl;
+	cerr << endl;
+	cerr.unsetf(ios_base::floatfield);
+	cerr << setprecision(6);
+	
+	loadPhases.clear();
+	fileTimes.clear();
 }
 
 
@@ -23,6 +23,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 class Color;
 class Conversation;
+class DataFile;
 class DataNode;
 class DataWriter;
 class Date;
@@ -62,10 +63,34 @@ public:
 	static void CheckReferences();
 	static void LoadShaders();
 	static double Progress();
-	// Begin loading a sprite that was previously deferred. Currently this is
-	// done with all landscapes to speed up the program's startup.
+	// Begin loading a sprite that was previously deferred, because it is about
+	// to be needed. This is done with all landscapes to speed up the program's
+	// startup, and with any other sprites that are loaded lazily.
 	static void Preload(const Sprite *sprite);
+	// Load any lazy sprites that were drawn without being loaded, and unload
+	// the ones that have not been used recently if their textures take up more
+	// memory than the budget allows. This should be called once per frame. The
+	// return value is true if any sprites may have been uploaded, which means
+	// anything that is drawing them must be redrawn.
+	static bool UpdateLazySprites();
+	// If the given sprite, or the sprites in the given system, have not been
+	// loaded yet, load them before any that are not needed as urgently.
+	static void Prioritize(const Sprite *sprite);
+	static void Prioritize(const System *system);
 	static void FinishLoading();
+	// Debugging aid for content creators: reload any data files that have been
+	// added or modified since they were loaded, and return how many there were.
+	// The changes made by events must be re-applied afterwards. This must not
+	// be called while the Engine's calculation thread is running.
+	static int ReloadChangedData();
+	// Watch the data directories for changes (currently only on Linux).
+	static void WatchData();
+	// Check if the data files should be reloaded, either because a change was
+	// seen in the data directories or because a reload was requested.
+	static bool HasDataChanged();
+	// Ask for the data files to be checked for changes the next time that it is
+	// safe to reload them (e.g. because the player pressed the reload key).
+	static void RequestReload();
 	
 	// Get the list of resource sources (i.e. plugin folders).
 	static const std::vector<std::string> &Sources();
@@ -141,8 +166,10 @@ public:
 private:
 	static void LoadSources();
 	static void LoadFile(const std::string &path, bool debugMode);
-	static std::map<std::string, std::shared_ptr<ImageSet>> FindImages();
+	static void LoadData(const DataFile &data);
+	static void FindImages();
 	
+	static void PrintLoadProfile();
 	static void PrintShipTable();
 	static void PrintWeaponTable();
 };
@@ -12,9 +12,16 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "ImageSet.h"
 
+#include "File.h"
+#include "Files.h"
 #include "Mask.h"
 #include "Sprite.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
 
 using namespace std;
@@ -46,6 +53,115 @@ namespace {
 		// are part of the sprite name, not a frame index.
 		return (IsBlend(path[pos]) ? pos : end);
 	}
+	
+	// Decoded images are cached as raw premultiplied pixels. Each cache file
+	// begins with this tag and a version number, which must be changed if the
+	// file layout or the way images are decoded ever changes.
+	const char CACHE_TAG[4] = {'E', 'S', 'I', 'C'};
+	const uint32_t CACHE_VERSION = 1;
+	// The pixel data begins at a multiple of this many bytes from the start of
+	// the file, so that the file can be memory-mapped and used directly.
+	const long CACHE_ALIGN = 16;
+	
+	// Collision masks are cached in separate files, keyed by a hash of the
+	// image they were generated from.
+	const char MASK_TAG[4] = {'E', 'S', 'M', 'C'};
+	const uint32_t MASK_VERSION = 1;
+	
+	// Statistics on the collision mask cache. The times are in microseconds.
+	atomic<int> masksLoaded(0);
+	atomic<int> masksGenerated(0);
+	atomic<long long> maskTimeSaved(0);
+	
+	// Use FNV-1a for all the cache hashes, so they are the same with every
+	// compiler and on every platform.
+	const uint64_t FNV_OFFSET = 14695981039346656037ull;
+	const uint64_t FNV_PRIME = 1099511628211ull;
+	
+	// Get the path to the cache file with the given hash.
+	string CachePath(uint64_t hash, const char *extension)
+	{
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "%016llx.%s", static_cast<unsigned long long>(hash), extension);
+		return Files::Cache() + buffer;
+	}
+	
+	// Get the path to the cache file for the sprite with the given name. A
+	// hash of the name is used rather than the name itself, because sprite
+	// names may contain characters that are not valid in file names.
+	string CachePath(const string &name)
+	{
+		uint64_t hash = FNV_OFFSET;
+		for(char c : name)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= FNV_PRIME;
+		}
+		return CachePath(hash, "sprite");
+	}
+	
+	// Hash the dimensions and contents of the given image. The masks only
+	// depend on these, so two identical images can share the same masks.
+	uint64_t HashImage(const ImageBuffer &image)
+	{
+		uint64_t hash = FNV_OFFSET;
+		auto add = [&hash](uint64_t value)
+		{
+			hash ^= value;
+			hash *= FNV_PRIME;
+		};
+		add(image.Width());
+		add(image.Height());
+		add(image.Frames());
+		
+		const uint32_t *it = image.Pixels();
+		const uint32_t *end = it + static_cast<size_t>(image.Width()) * image.Height() * image.Frames();
+		for( ; it != end; ++it)
+			add(*it);
+		return hash;
+	}
+	
+	// The key identifies exactly which source files a cache file was created
+	// from. If any of them is replaced, modified, or added, the key changes.
+	void AddToKey(string &key, const vector<string> &paths, size_t frames)
+	{
+		for(size_t i = 0; i < frames && i < paths.size(); ++i)
+		{
+			key += paths[i];
+			key += '\n';
+			key += to_string(Files::Timestamp(paths[i]));
+			key += ' ';
+			key += to_string(Files::Size(paths[i]));
+			key += '\n';
+		}
+		key += '\n';
+	}
+	
+	template <class Type>
+	bool ReadValue(FILE *file, Type &value)
+	{
+		return (fread(&value, sizeof(value), 1, file) == 1);
+	}
+	
+	template <class Type>
+	bool WriteValue(FILE *file, const Type &value)
+	{
+		return (fwrite(&value, sizeof(value), 1, file) == 1);
+	}
+	
+	// Skip to the next aligned position in the file.
+	bool Align(FILE *file, bool write)
+	{
+		long pos = ftell(file);
+		if(pos < 0)
+			return false;
+		
+		static const char ZEROS[CACHE_ALIGN] = {};
+		long padding = (CACHE_ALIGN - pos % CACHE_ALIGN) % CACHE_ALIGN;
+		if(write)
+			return (fwrite(ZEROS, 1, padding, file) == static_cast<size_t>(padding));
+		return !fseek(file, padding, SEEK_CUR);
+	}
 }
 
 
@@ -195,23 +311,45 @@ void ImageSet::Load()
 	// not actually be allocated until the first image is loaded (at which point
 	// the sprite's dimensions will be known).
 	size_t frames = paths[0].size();
-	buffer[0].Clear(frames);
-	buffer[1].Clear(frames);
 	
-	// Check whether we need to generate collision masks.
-	bool makeMasks = IsMasked(name);
-	if(makeMasks)
-		masks.resize(frames);
+	// Landscapes are only loaded when they are needed, and are much larger than
+	// the compressed files they come from, so they are never cached.
+	bool useCache = !IsDeferred(name) && !Files::Cache().empty();
+	string key;
+	if(useCache)
+	{
+		key = name + '\n';
+		AddToKey(key, paths[0], frames);
+		AddToKey(key, paths[1], frames);
+	}
 	
-	// Load the 1x sprites first, then the 2x sprites, because they are likely
-	// to be in separate locations on the disk. Create masks if needed.
-	for(size_t i = 0; i < frames; ++i)
-		if(buffer[0].Read(paths[0][i], i) && makeMasks)
-			masks[i].Create(buffer[0], i);
-	// Now, load the 2x sprites, if they exist. Because the number of 1x frames
-	// is definitive, don't load any frames beyond the size of the 1x list.
-	for(size_t i = 0; i < frames && i < paths[1].size(); ++i)
-		buffer[1].Read(paths[1][i], i);
+	// If the decoded frames are in the cache, there is no need to decode them.
+	bool isCached = (useCache && ReadCache(key));
+	if(!isCached)
+	{
+		buffer[0].Clear(frames);
+		buffer[1].Clear(frames);
+		
+		// Load the 1x sprites first, then the 2x sprites, because they are
+		// likely to be in separate locations on the disk.
+		bool isValid = true;
+		for(size_t i = 0; i < frames; ++i)
+			isValid &= buffer[0].Read(paths[0][i], i);
+		// Now, load the 2x sprites, if they exist. Because the number of 1x
+		// frames is definitive, don't load any frames beyond the size of the
+		// 1x list.
+		for(size_t i = 0; i < frames && i < paths[1].size(); ++i)
+			isValid &= buffer[1].Read(paths[1][i], i);
+		
+		// Don't cache sprites with missing or unreadable frames, so that the
+		// errors are not hidden the next time the game is launched.
+		if(useCache && isValid)
+			WriteCache(key);
+	}
+	
+	// Check whether we need to generate collision masks.
+	if(IsMasked(name) && buffer[0].Pixels())
+		LoadMasks();
 }
 
 
@@ -222,7 +360,182 @@ void ImageSet::Load()
 void ImageSet::Upload(Sprite *sprite)
 {
 	// Load the frames. This will clear the buffers and the mask vector.
-	sprite->AddFrames(buffer[0], false);
-	sprite->AddFrames(buffer[1], true);
+	bool createTextures = !isLazy;
+	isLazy = false;
+	sprite->AddFrames(buffer[0], false, createTextures);
+	sprite->AddFrames(buffer[1], true, createTextures);
 	sprite->AddMasks(masks);
 }
+
+
+
+// Mark this as a sprite whose textures are only loaded when needed. The
+// first time it is uploaded, the sprite only gets its size and masks; the
+// textures are created the next time the images are loaded and uploaded.
+void ImageSet::SetLazy()
+{
+	isLazy = true;
+}
+
+
+
+// Get statistics on the collision mask cache: how many sprites had their
+// masks loaded from it or generated, and how much load time it saved.
+void ImageSet::MaskCacheStatistics(int *loaded, int *generated, double *secondsSaved)
+{
+	*loaded = masksLoaded;
+	*generated = masksGenerated;
+	*secondsSaved = maskTimeSaved * .000001;
+}
+
+
+
+// Try to load all the frames from the cache. Return false if the cache does
+// not exist or was created from different source images.
+bool ImageSet::ReadCache(const string &key)
+{
+	File file(CachePath(name));
+	if(!file)
+		return false;
+	
+	char tag[sizeof(CACHE_TAG)];
+	uint32_t version = 0;
+	uint32_t keyLength = 0;
+	if(fread(tag, 1, sizeof(tag), file) != sizeof(tag) || !equal(tag, tag + sizeof(tag), CACHE_TAG))
+		return false;
+	if(!ReadValue(file, version) || version != CACHE_VERSION)
+		return false;
+	if(!ReadValue(file, keyLength) || keyLength != key.length())
+		return false;
+	string cachedKey(keyLength, '\0');
+	if(keyLength && fread(&cachedKey[0], 1, keyLength, file) != keyLength)
+		return false;
+	if(cachedKey != key)
+		return false;
+	
+	int32_t size[2][3];
+	for(int i = 0; i < 2; ++i)
+		for(int j = 0; j < 3; ++j)
+			if(!ReadValue(file, size[i][j]) || size[i][j] < 0)
+				return false;
+	if(!Align(file, false))
+		return false;
+	
+	for(int i = 0; i < 2; ++i)
+	{
+		buffer[i].Clear(size[i][2]);
+		buffer[i].Allocate(size[i][0], size[i][1]);
+		if(!buffer[i].Pixels())
+			continue;
+		
+		size_t count = static_cast<size_t>(size[i][0]) * size[i][1] * size[i][2];
+		if(fread(buffer[i].Pixels(), sizeof(uint32_t), count, file) != count)
+		{
+			buffer[0].Clear();
+			buffer[1].Clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+// Save the decoded frames to the cache. The file is written under a temporary
+// name first, so that no other process can ever see a partial file.
+void ImageSet::WriteCache(const string &key) const
+{
+	string path = CachePath(name);
+	string temporary = path + ".tmp";
+	bool isWritten = false;
+	{
+		File file(temporary, true);
+		if(!file)
+			return;
+		
+		isWritten = (fwrite(CACHE_TAG, 1, sizeof(CACHE_TAG), file) == sizeof(CACHE_TAG));
+		isWritten &= WriteValue(file, CACHE_VERSION);
+		isWritten &= WriteValue(file, static_cast<uint32_t>(key.length()));
+		isWritten &= (fwrite(key.data(), 1, key.length(), file) == key.length());
+		for(const ImageBuffer &it : buffer)
+		{
+			bool isEmpty = !it.Pixels();
+			isWritten &= WriteValue(file, static_cast<int32_t>(isEmpty ? 0 : it.Width()));
+			isWritten &= WriteValue(file, static_cast<int32_t>(isEmpty ? 0 : it.Height()));
+			isWritten &= WriteValue(file, static_cast<int32_t>(isEmpty ? 0 : it.Frames()));
+		}
+		isWritten &= Align(file, true);
+		for(const ImageBuffer &it : buffer)
+			if(it.Pixels())
+			{
+				size_t count = static_cast<size_t>(it.Width()) * it.Height() * it.Frames();
+				isWritten &= (fwrite(it.Pixels(), sizeof(uint32_t), count, file) == count);
+			}
+	}
+	if(isWritten)
+		Files::Move(temporary, path);
+	else
+		Files::Delete(temporary);
+}
+
+
+
+// Load the collision masks from the cache, or generate them from the 1x image
+// and add them to the cache.
+void ImageSet::LoadMasks()
+{
+	auto start = chrono::steady_clock::now();
+	auto elapsed = [&start]() -> long long
+	{
+		return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+	};
+	
+	size_t frames = buffer[0].Frames();
+	string path = CachePath(HashImage(buffer[0]), "mask");
+	masks.resize(frames);
+	{
+		File file(path);
+		char tag[sizeof(MASK_TAG)];
+		uint32_t version = 0;
+		uint32_t count = 0;
+		long long generationTime = 0;
+		bool isValid = file
+			&& fread(tag, 1, sizeof(tag), file) == sizeof(tag) && equal(tag, tag + sizeof(tag), MASK_TAG)
+			&& ReadValue(file, version) && version == MASK_VERSION
+			&& ReadValue(file, count) && count == frames
+			&& ReadValue(file, generationTime);
+		for(size_t i = 0; isValid && i < frames; ++i)
+			isValid = masks[i].Read(file);
+		
+		if(isValid)
+		{
+			++masksLoaded;
+			maskTimeSaved += generationTime - elapsed();
+			return;
+		}
+	}
+	
+	for(size_t i = 0; i < frames; ++i)
+		masks[i].Create(buffer[0], i);
+	long long generationTime = elapsed();
+	++masksGenerated;
+	
+	string temporary = path + ".tmp";
+	bool isWritten = false;
+	{
+		File file(temporary, true);
+		if(!file)
+			return;
+		
+		isWritten = (fwrite(MASK_TAG, 1, sizeof(MASK_TAG), file) == sizeof(MASK_TAG));
+		isWritten &= WriteValue(file, MASK_VERSION);
+		isWritten &= WriteValue(file, static_cast<uint32_t>(frames));
+		isWritten &= WriteValue(file, generationTime);
+		for(const Mask &mask : masks)
+			isWritten &= mask.Write(file);
+	}
+	if(isWritten)
+		Files::Move(temporary, path);
+	else
+		Files::Delete(temporary);
+}
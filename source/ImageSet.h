@@ -43,6 +43,9 @@ public:
 	// Determine whether the given path or name is to a sprite for which a
 	// collision mask ought to be generated.
 	static bool IsMasked(const std::string &path);
+	// Get statistics on the collision mask cache: how many sprites had their
+	// masks loaded from it or generated, and how much load time it saved.
+	static void MaskCacheStatistics(int *loaded, int *generated, double *secondsSaved);
 	
 	
 public:
@@ -65,6 +68,19 @@ public:
 	// called, the internal image buffers and mask vector will be cleared, but
 	// the paths are saved in case the sprite needs to be loaded again.
 	void Upload(Sprite *sprite);
+	// Mark this as a sprite whose textures are only loaded when needed. The
+	// first time it is uploaded, the sprite only gets its size and masks; the
+	// textures are created the next time the images are loaded and uploaded.
+	void SetLazy();
+	
+	
+private:
+	// Read the decoded frames from the disk cache, or write them to it. The
+	// key describes the source files, and must match for the cache to be used.
+	bool ReadCache(const std::string &key);
+	void WriteCache(const std::string &key) const;
+	// Load the collision masks from their cache, or generate and cache them.
+	void LoadMasks();
 	
 	
 private:
@@ -75,6 +91,7 @@ private:
 	// Data loaded from the images:
 	ImageBuffer buffer[2];
 	std::vector<Mask> masks;
+	bool isLazy = false;
 };
 
 
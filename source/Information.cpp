@@ -14,93 +14,205 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Sprite.h"
 
+#include <unordered_map>
+
 using namespace std;
 
+namespace {
+	// Make sure the given vector has an entry for the given index.
+	template <class Type>
+	Type &Slot(vector<Type> &values, int index)
+	{
+		if(static_cast<size_t>(index) >= values.size())
+			values.resize(index + 1);
+		return values[index];
+	}
+	
+	// Check if the given index refers to an entry in the given vector.
+	template <class Type>
+	bool InRange(const vector<Type> &values, int index)
+	{
+		return (index >= 0 && static_cast<size_t>(index) < values.size());
+	}
+}
+
+
+
+// Get the index for the given name, assigning a new one if necessary.
+int Information::Index(const string &name)
+{
+	static unordered_map<string, int> indices;
+	
+	auto it = indices.emplace(name, static_cast<int>(indices.size())).first;
+	return it->second;
+}
+
+
+
+// Forget all the information, but keep the memory allocated for it so that
+// the same object can be filled in again on the next frame.
+void Information::Clear()
+{
+	sprites.assign(sprites.size(), SpriteInfo());
+	for(string &str : strings)
+		str.clear();
+	bars.assign(bars.size(), BarInfo());
+	conditions.assign(conditions.size(), false);
+	outlineColor = Color();
+}
+
 
 
 void Information::SetSprite(const string &name, const Sprite *sprite, const Point &unit, float frame)
 {
-	sprites[name] = sprite;
-	spriteUnits[name] = unit;
-	spriteFrames[name] = frame;
+	SetSprite(Index(name), sprite, unit, frame);
+}
+
+
+
+void Information::SetSprite(int index, const Sprite *sprite, const Point &unit, float frame)
+{
+	SpriteInfo &info = Slot(sprites, index);
+	info.sprite = sprite;
+	info.unit = unit;
+	info.frame = frame;
+	info.isSet = true;
 }
 
 
 
 const Sprite *Information::GetSprite(const string &name) const
+{
+	return GetSprite(Index(name));
+}
+
+
+
+const Sprite *Information::GetSprite(int index) const
 {
 	static const Sprite empty;
 	
-	auto it = sprites.find(name);
-	return (it == sprites.end()) ? &empty : it->second;
+	return (InRange(sprites, index) && sprites[index].isSet) ? sprites[index].sprite : &empty;
 }
 
 
 
 const Point &Information::GetSpriteUnit(const string &name) const
+{
+	return GetSpriteUnit(Index(name));
+}
+
+
+
+const Point &Information::GetSpriteUnit(int index) const
 {
 	static const Point up(0., -1.);
 	
-	auto it = spriteUnits.find(name);
-	return (it == spriteUnits.end()) ? up : it->second;
+	return InRange(sprites, index) ? sprites[index].unit : up;
 }
 
 
 
 float Information::GetSpriteFrame(const string &name) const
 {
-	auto it = spriteFrames.find(name);
-	return (it == spriteFrames.end()) ? 0.f : it->second;
+	return GetSpriteFrame(Index(name));
+}
+
+
+
+float Information::GetSpriteFrame(int index) const
+{
+	return InRange(sprites, index) ? sprites[index].frame : 0.f;
 }
 
 
 
 void Information::SetString(const string &name, const string &value)
 {
-	strings[name] = value;
+	SetString(Index(name), value);
+}
+
+
+
+void Information::SetString(int index, const string &value)
+{
+	Slot(strings, index) = value;
 }
 
 
 
 const string &Information::GetString(const string &name) const
+{
+	return GetString(Index(name));
+}
+
+
+
+const string &Information::GetString(int index) const
 {
 	static const string empty;
 	
-	auto it = strings.find(name);
-	return (it == strings.end()) ? empty : it->second;
+	return InRange(strings, index) ? strings[index] : empty;
 }
 
 
 
 void Information::SetBar(const string &name, double value, double segments)
 {
-	bars[name] = value;
-	barSegments[name] = static_cast<double>(segments);
+	SetBar(Index(name), value, segments);
+}
+
+
+
+void Information::SetBar(int index, double value, double segments)
+{
+	BarInfo &bar = Slot(bars, index);
+	bar.value = value;
+	bar.segments = segments;
 }
 
 
 
 double Information::BarValue(const string &name) const
 {
-	auto it = bars.find(name);
-	
-	return (it == bars.end()) ? 0. : it->second;
+	return BarValue(Index(name));
+}
+
+
+
+double Information::BarValue(int index) const
+{
+	return InRange(bars, index) ? bars[index].value : 0.;
 }
 
 
 
 double Information::BarSegments(const string &name) const
 {
-	auto it = barSegments.find(name);
-	
-	return (it == barSegments.end()) ? 1. : it->second;
+	return BarSegments(Index(name));
 }
 
 
-	
+
+double Information::BarSegments(int index) const
+{
+	return InRange(bars, index) ? bars[index].segments : 1.;
+}
+
+
+
 void Information::SetCondition(const string &condition)
 {
-	conditions.insert(condition);
+	SetCondition(Index(condition));
+}
+
+
+
+void Information::SetCondition(int index)
+{
+	if(static_cast<size_t>(index) >= conditions.size())
+		conditions.resize(index + 1, false);
+	conditions[index] = true;
 }
 
 
@@ -113,11 +225,18 @@ bool Information::HasCondition(const string &condition) const
 	if(condition.front() == '!')
 		return !HasCondition(condition.substr(1));
 	
-	return conditions.count(condition);
+	return HasCondition(Index(condition));
 }
 
 
-	
+
+bool Information::HasCondition(int index) const
+{
+	return InRange(conditions, index) && conditions[index];
+}
+
+
+
 void Information::SetOutlineColor(const Color &color)
 {
 	outlineColor = color;
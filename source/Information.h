@@ -16,46 +16,82 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Color.h"
 #include "Point.h"
 
-#include <map>
-#include <set>
 #include <string>
+#include <vector>
 
 class Sprite;
 
 
 
 // Class representing information to be displayed in a user interface, independent
-// of how that information is laid out or shown.
+// of how that information is laid out or shown. Every name that is used for a
+// sprite, string, bar, or condition is given a fixed index the first time it is
+// seen, and the information is stored in flat arrays by index. Code that sets
+// or reads the same information every frame (e.g. the HUD) can look up the
+// indices once and use them from then on instead of the names.
 class Information {
 public:
+	// Get the index for the given name, assigning a new one if necessary.
+	static int Index(const std::string &name);
+	
+	// Forget all the information, but keep the memory allocated for it so that
+	// the same object can be filled in again on the next frame.
+	void Clear();
+	
 	void SetSprite(const std::string &name, const Sprite *sprite, const Point &unit = Point(0., -1.), float frame = 0.f);
+	void SetSprite(int index, const Sprite *sprite, const Point &unit = Point(0., -1.), float frame = 0.f);
 	const Sprite *GetSprite(const std::string &name) const;
+	const Sprite *GetSprite(int index) const;
 	const Point &GetSpriteUnit(const std::string &name) const;
+	const Point &GetSpriteUnit(int index) const;
 	float GetSpriteFrame(const std::string &name) const;
+	float GetSpriteFrame(int index) const;
 	
 	void SetString(const std::string &name, const std::string &value);
+	void SetString(int index, const std::string &value);
 	const std::string &GetString(const std::string &name) const;
+	const std::string &GetString(int index) const;
 	
 	void SetBar(const std::string &name, double value, double segments = 0.);
+	void SetBar(int index, double value, double segments = 0.);
 	double BarValue(const std::string &name) const;
+	double BarValue(int index) const;
 	double BarSegments(const std::string &name) const;
+	double BarSegments(int index) const;
 	
+	// A condition name beginning with "!" is true if the condition is not set.
 	void SetCondition(const std::string &condition);
+	void SetCondition(int index);
 	bool HasCondition(const std::string &condition) const;
+	bool HasCondition(int index) const;
 	
 	void SetOutlineColor(const Color &color);
 	const Color &GetOutlineColor() const;
 	
 	
 private:
-	std::map<std::string, const Sprite *> sprites;
-	std::map<std::string, Point> spriteUnits;
-	std::map<std::string, float> spriteFrames;
-	std::map<std::string, std::string> strings;
-	std::map<std::string, double> bars;
-	std::map<std::string, double> barSegments;
+	class SpriteInfo {
+	public:
+		const Sprite *sprite = nullptr;
+		Point unit = Point(0., -1.);
+		float frame = 0.f;
+		bool isSet = false;
+	};
+	
+	class BarInfo {
+	public:
+		double value = 0.;
+		double segments = 1.;
+	};
 	
-	std::set<std::string> conditions;
+	
+private:
+	// Each of these is indexed by the name's index, and may be shorter than the
+	// number of names if the later ones have not been set.
+	std::vector<SpriteInfo> sprites;
+	std::vector<std::string> strings;
+	std::vector<BarInfo> bars;
+	std::vector<bool> conditions;
 	
 	Color outlineColor;
 };
@@ -176,6 +176,33 @@ double Interface::GetValue(const string &name) const
 
 
 
+// Members of the Condition class:
+
+// Look up the index of the named condition now, so it never has to be looked
+// up by name when the interface is drawn.
+Interface::Condition::Condition(const string &condition)
+{
+	size_t start = 0;
+	while(start < condition.length() && condition[start] == '!')
+	{
+		isNegated = !isNegated;
+		++start;
+	}
+	if(start < condition.length())
+		index = Information::Index(condition.substr(start));
+}
+
+
+
+bool Interface::Condition::Check(const Information &info) const
+{
+	// An empty condition is always true.
+	bool isSet = (index < 0 || info.HasCondition(index));
+	return isSet != isNegated;
+}
+
+
+
 // Members of the AnchoredPoint class:
 
 // Get the point's location, given the current screen dimensions.
@@ -296,13 +323,13 @@ void Interface::Element::Load(const DataNode &node, const Point &globalAnchor)
 // button, it will add a clickable zone to the given panel.
 void Interface::Element::Draw(const Information &info, Panel *panel) const
 {
-	if(!info.HasCondition(visibleIf))
+	if(!visibleIf.Check(info))
 		return;
 	
 	// Get the bounding box of this element, relative to the anchor point.
 	Rectangle box = Bounds();
 	// Check if this element is active.
-	int state = info.HasCondition(activeIf);
+	int state = activeIf.Check(info);
 	// Check if the mouse is hovering over this element.
 	state += (state && box.Contains(UI::GetMouse()));
 	// Place buttons even if they are inactive, in case the UI wants to show a
@@ -324,8 +351,8 @@ void Interface::Element::Draw(const Information &info, Panel *panel) const
 // An empty string means it is always visible or active.
 void Interface::Element::SetConditions(const string &visible, const string &active)
 {
-	visibleIf = visible;
-	activeIf = active;
+	visibleIf = Condition(visible);
+	activeIf = Condition(active);
 }
 
 
@@ -385,7 +412,10 @@ Interface::ImageElement::ImageElement(const DataNode &node, const Point &globalA
 	if(node.Token(0) == "sprite")
 		sprite[Element::ACTIVE] = SpriteSet::Get(node.Token(1));
 	else
+	{
 		name = node.Token(1);
+		index = Information::Index(name);
+	}
 	
 	// This function will call ParseLine() for any line it does not recognize.
 	Load(node, globalAnchor);
@@ -450,11 +480,11 @@ void Interface::ImageElement::Draw(const Rectangle &rect, const Information &inf
 	if(!sprite || !sprite->Width() || !sprite->Height())
 		return;
 	
-	float frame = info.GetSpriteFrame(name);
+	float frame = info.GetSpriteFrame(index);
 	if(isOutline)
 	{
 		Color color = (isColored ? info.GetOutlineColor() : Color(1., 1.));
-		Point unit = info.GetSpriteUnit(name);
+		Point unit = info.GetSpriteUnit(index);
 		OutlineShader::Draw(sprite, rect.Center(), rect.Dimensions(), color, unit, frame);
 	}
 	else
@@ -465,7 +495,7 @@ void Interface::ImageElement::Draw(const Rectangle &rect, const Information &inf
 
 const Sprite *Interface::ImageElement::GetSprite(const Information &info, int state) const
 {
-	return name.empty() ? sprite[state] : info.GetSprite(name);
+	return name.empty() ? sprite[state] : info.GetSprite(index);
 }
 
 
@@ -487,6 +517,8 @@ Interface::TextElement::TextElement(const DataNode &node, const Point &globalAnc
 	}
 	else
 		str = node.Token(1);
+	if(isDynamic)
+		index = Information::Index(str);
 	
 	// This function will call ParseLine() for any line it does not recognize.
 	Load(node, globalAnchor);
@@ -541,8 +573,7 @@ bool Interface::TextElement::ParseLine(const DataNode &node)
 Point Interface::TextElement::NativeDimensions(const Information &info, int state) const
 {
 	const Font &font = FontSet::Get(fontSize);
-	string text = GetString(info);
-	return Point(font.Width(text), font.Height());
+	return Point(font.Width(GetString(info)), font.Height());
 }
 
 
@@ -569,9 +600,9 @@ void Interface::TextElement::Place(const Rectangle &bounds, Panel *panel) const
 
 
 
-string Interface::TextElement::GetString(const Information &info) const
+const string &Interface::TextElement::GetString(const Information &info) const
 {
-	return (isDynamic ? info.GetString(str) : str);
+	return (isDynamic ? info.GetString(index) : str);
 }
 
 
@@ -585,7 +616,7 @@ Interface::BarElement::BarElement(const DataNode &node, const Point &globalAncho
 		return;
 	
 	// Get the name of the element and find out what type it is (bar or ring).
-	name = node.Token(1);
+	index = Information::Index(node.Token(1));
 	isRing = (node.Token(0) == "ring");
 	
 	// This function will call ParseLine() for any line it does not recognize.
@@ -618,8 +649,8 @@ bool Interface::BarElement::ParseLine(const DataNode &node)
 void Interface::BarElement::Draw(const Rectangle &rect, const Information &info, int state) const
 {
 	// Get the current settings for this bar or ring.
-	double value = info.BarValue(name);
-	double segments = info.BarSegments(name);
+	double value = info.BarValue(index);
+	double segments = info.BarSegments(index);
 	if(segments <= 1.)
 		segments = 0.;
 	
@@ -52,6 +52,21 @@ public:
 	
 	
 private:
+	// A condition that is checked by looking up its index in an Information
+	// object, rather than its name. An empty condition is always true, and one
+	// that begins with "!" is true only if the named condition is not set.
+	class Condition {
+	public:
+		Condition() = default;
+		explicit Condition(const std::string &condition);
+		
+		bool Check(const Information &info) const;
+	
+	private:
+		int index = -1;
+		bool isNegated = false;
+	};
+	
 	class AnchoredPoint {
 	public:
 		// Get the point's location, given the current screen dimensions.
@@ -108,8 +123,8 @@ private:
 		AnchoredPoint to;
 		Point alignment;
 		Point padding;
-		std::string visibleIf;
-		std::string activeIf;
+		Condition visibleIf;
+		Condition activeIf;
 	};
 	
 	// This class handles "sprite", "image", and "outline" elements.
@@ -132,6 +147,7 @@ private:
 	private:
 		// If a name is given, look up the sprite with that name and draw it.
 		std::string name;
+		int index = -1;
 		// Otherwise, draw a sprite. Which sprite is drawn depends on the current
 		// state of this element: inactive, active, or hover.
 		const Sprite *sprite[3] = {nullptr, nullptr, nullptr};
@@ -159,11 +175,12 @@ private:
 		virtual void Place(const Rectangle &bounds, Panel *panel) const override;
 		
 	private:
-		std::string GetString(const Information &info) const;
+		const std::string &GetString(const Information &info) const;
 	
 	private:
 		// The string may either be a name of a dynamic string, or static text.
 		std::string str;
+		int index = -1;
 		// Color for inactive, active, and hover states.
 		const Color *color[3] = {nullptr, nullptr, nullptr};
 		int fontSize = 14;
@@ -184,7 +201,7 @@ private:
 		virtual void Draw(const Rectangle &rect, const Information &info, int state) const override;
 		
 	private:
-		std::string name;
+		int index = -1;
 		const Color *color = nullptr;
 		float width = 2.f;
 		bool isRing = false;
@@ -108,6 +108,17 @@ void ItemInfoDisplay::DrawTooltips() const
 
 
 
+// Check if a tooltip is waiting to appear or disappear, which means the
+// tooltips must be drawn again on the next frame even if nothing else changes.
+bool ItemInfoDisplay::IsAnimating() const
+{
+	// Once a tooltip is fully shown, drawing it leaves the count one below the
+	// maximum. Any other nonzero count means it is still changing.
+	return hoverCount && hoverCount != HOVER_TIME - 1;
+}
+
+
+
 // Update the location where the mouse is hovering.
 void ItemInfoDisplay::Hover(const Point &point)
 {
@@ -41,6 +41,9 @@ public:
 	void DrawDescription(const Point &topLeft) const;
 	virtual void DrawAttributes(const Point &topLeft) const;
 	void DrawTooltips() const;
+	// Check if a tooltip is waiting to appear or disappear, which means the
+	// tooltips must be drawn again on the next frame even if nothing else changes.
+	bool IsAnimating() const;
 	
 	// Update the location where the mouse is hovering.
 	void Hover(const Point &point);
@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Point.h"
 #include "Screen.h"
 #include "Shader.h"
+#include "VertexBatch.h"
 
 #include <stdexcept>
 
@@ -31,6 +32,13 @@ namespace {
 	
 	GLuint vao;
 	GLuint vbo;
+	
+	// The batch shader reads the line ends, width, and color from each vertex.
+	Shader batchShader;
+	// Each vertex has fifteen floats: the two ends (map position and pixel
+	// offset), the corner of the line, the width, and the color.
+	const int VERTEX_FLOATS = 15;
+	const vector<VertexBatch::Attribute> LAYOUT = {{"from", 4}, {"to", 4}, {"vert", 2}, {"width", 1}, {"color", 4}};
 }
 
 
@@ -93,6 +101,43 @@ void LineShader::Init()
 	// unbind the VBO and VAO
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
+	
+	static const char *batchVertexCode =
+		"uniform vec2 scale;\n"
+		"uniform vec2 center;\n"
+		"uniform float zoom;\n"
+		
+		"in vec4 from;\n"
+		"in vec4 to;\n"
+		"in vec2 vert;\n"
+		"in float width;\n"
+		"in vec4 color;\n"
+		"out vec2 tpos;\n"
+		"out float tscale;\n"
+		"out vec4 fragColor;\n"
+		
+		"void main() {\n"
+		"  vec2 start = (from.xy + center) * zoom + from.zw;\n"
+		"  vec2 len = (to.xy + center) * zoom + to.zw - start;\n"
+		"  vec2 unit = (length(len) > 0) ? normalize(len) : vec2(1, 0);\n"
+		"  tpos = vert;\n"
+		"  tscale = length(len);\n"
+		"  fragColor = color;\n"
+		"  gl_Position = vec4((start + vert.x * len + vert.y * width * vec2(unit.y, -unit.x)) * scale, 0, 1);\n"
+		"}\n";
+	
+	static const char *batchFragmentCode =
+		"in vec2 tpos;\n"
+		"in float tscale;\n"
+		"in vec4 fragColor;\n"
+		"out vec4 finalColor;\n"
+		
+		"void main() {\n"
+		"  float alpha = min(tscale - abs(tpos.x * (2 * tscale) - tscale), 1 - abs(tpos.y));\n"
+		"  finalColor = fragColor * alpha;\n"
+		"}\n";
+	
+	batchShader = Shader(batchVertexCode, batchFragmentCode);
 }
 
 
@@ -126,3 +171,42 @@ void LineShader::Draw(const Point &from, const Point &to, float width, const Col
 	glBindVertexArray(0);
 	glUseProgram(0);
 }
+
+
+
+void LineShader::Batch::Clear()
+{
+	vertices.Clear();
+}
+
+
+
+void LineShader::Batch::Add(const Point &from, const Point &fromOffset, const Point &to, const Point &toOffset,
+	float width, const Color &color)
+{
+	// Each line is drawn as two triangles.
+	static const float CORNERS[6][2] = {{0.f, -1.f}, {1.f, -1.f}, {0.f, 1.f}, {1.f, -1.f}, {0.f, 1.f}, {1.f, 1.f}};
+	const float *rgba = color.Get();
+	for(const float *corner : CORNERS)
+	{
+		const float vertex[VERTEX_FLOATS] = {
+			static_cast<float>(from.X()), static_cast<float>(from.Y()),
+			static_cast<float>(fromOffset.X()), static_cast<float>(fromOffset.Y()),
+			static_cast<float>(to.X()), static_cast<float>(to.Y()),
+			static_cast<float>(toOffset.X()), static_cast<float>(toOffset.Y()),
+			corner[0], corner[1], width, rgba[0], rgba[1], rgba[2], rgba[3]};
+		vertices.Add(vertex, VERTEX_FLOATS);
+	}
+}
+
+
+
+// Draw the lines, with the given map position at the center of the screen
+// and the given zoom factor.
+void LineShader::Batch::Draw(const Point &center, double zoom) const
+{
+	if(!batchShader.Object())
+		throw runtime_error("LineShader: Draw() called before Init().");
+	
+	vertices.Draw(batchShader, LAYOUT, center, zoom);
+}
@@ -13,14 +13,37 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef LINE_SHADER_H_
 #define LINE_SHADER_H_
 
+#include "Point.h"
+#include "VertexBatch.h"
+
 class Color;
-class Point;
 
 
 
 // Class to be used for drawing lines. The sides of a line are anti-aliased, but
 // the start and end of the line are not.
 class LineShader {
+public:
+	// A set of lines that are stored in a vertex buffer, so that they can all
+	// be drawn with a single command. The ends of each line are given as a
+	// position in map coordinates, which move and scale along with the view,
+	// plus an offset in screen pixels, which does not. That way the lines only
+	// need to be rebuilt when the lines themselves change, not when the view
+	// is panned or zoomed.
+	class Batch {
+	public:
+		void Clear();
+		void Add(const Point &from, const Point &fromOffset, const Point &to, const Point &toOffset,
+			float width, const Color &color);
+		// Draw the lines, with the given map position at the center of the
+		// screen and the given zoom factor.
+		void Draw(const Point &center, double zoom) const;
+	
+	private:
+		VertexBatch vertices;
+	};
+	
+	
 public:
 	static void Init();
 	
@@ -0,0 +1,138 @@
+/* LockFreeQueue.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef LOCK_FREE_QUEUE_H_
+#define LOCK_FREE_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+
+
+// Fixed-size first-in, first-out queue that any number of threads can add
+// items to and remove items from at the same time, without ever taking a lock
+// or blocking. Instead, adding to a full queue or removing from an empty one
+// fails, and the caller must decide whether to try again later. Each slot in
+// the ring buffer has a sequence number that tells whether it is ready to be
+// written or read in the current pass around the ring.
+template <class Type>
+class LockFreeQueue {
+public:
+	// The capacity is rounded up to a power of two.
+	explicit LockFreeQueue(size_t capacity);
+	LockFreeQueue(const LockFreeQueue &) = delete;
+	LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+	
+	// Add an item to the end of the queue. Return false if the queue is full.
+	bool Push(Type value);
+	// Remove the item at the front of the queue. Return false if it is empty.
+	bool Pop(Type &value);
+	
+	
+private:
+	class Slot {
+	public:
+		std::atomic<size_t> sequence;
+		Type value;
+	};
+	
+	
+private:
+	std::unique_ptr<Slot[]> slots;
+	size_t mask;
+	// Keep the two ends of the queue in separate cache lines, so that threads
+	// adding items and threads removing them do not slow each other down.
+	alignas(64) std::atomic<size_t> back;
+	alignas(64) std::atomic<size_t> front;
+};
+
+
+
+template <class Type>
+LockFreeQueue<Type>::LockFreeQueue(size_t capacity)
+	: back(0), front(0)
+{
+	size_t size = 2;
+	while(size < capacity)
+		size *= 2;
+	
+	slots.reset(new Slot[size]);
+	mask = size - 1;
+	for(size_t i = 0; i < size; ++i)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+
+
+template <class Type>
+bool LockFreeQueue<Type>::Push(Type value)
+{
+	size_t position = back.load(std::memory_order_relaxed);
+	while(true)
+	{
+		Slot &slot = slots[position & mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		// If the slot's sequence number matches, it is empty and no other thread
+		// has claimed it yet. If it is behind, the reader has not finished with
+		// the item that was put there on the last pass, so the queue is full.
+		// Otherwise, another thread got here first, so try the next position.
+		if(sequence == position)
+		{
+			if(back.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				slot.value = std::move(value);
+				slot.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if(sequence < position)
+			return false;
+		else
+			position = back.load(std::memory_order_relaxed);
+	}
+}
+
+
+
+template <class Type>
+bool LockFreeQueue<Type>::Pop(Type &value)
+{
+	size_t position = front.load(std::memory_order_relaxed);
+	while(true)
+	{
+		Slot &slot = slots[position & mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		// The slot holds an item once its writer has set its sequence number to
+		// one past the position. Once the item is taken, the sequence number is
+		// set to the position the slot will have on the next pass.
+		if(sequence == position + 1)
+		{
+			if(front.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				value = std::move(slot.value);
+				slot.value = Type();
+				slot.sequence.store(position + mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if(sequence < position + 1)
+			return false;
+		else
+			position = front.load(std::memory_order_relaxed);
+	}
+}
+
+
+
+#endif
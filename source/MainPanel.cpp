@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "BoardingPanel.h"
 #include "Command.h"
 #include "Dialog.h"
+#include "FogShader.h"
 #include "Font.h"
 #include "FontSet.h"
 #include "Format.h"
@@ -52,6 +53,8 @@ MainPanel::MainPanel(PlayerInfo &player)
 	: player(player), engine(player)
 {
 	SetIsFullScreen(true);
+	// The game view only changes while the game is running.
+	SetIsStatic(true);
 }
 
 
@@ -60,6 +63,11 @@ void MainPanel::Step()
 {
 	engine.Wait();
 	
+	// In debug mode, reload any data files that have changed. This can only be
+	// done now, while the Engine's calculation thread is not running.
+	if(GameData::HasDataChanged())
+		ReloadData();
+	
 	// Depending on what UI element is on top, the game is "paused." This
 	// checks only already-drawn panels.
 	bool isActive = GetUI()->IsTop(this);
@@ -128,7 +136,10 @@ void MainPanel::Step()
 	StepEvents(isActive);
 	
 	if(isActive)
+	{
 		engine.Go();
+		SetDirty();
+	}
 	else
 		canDrag = false;
 	canClick = isActive;
@@ -286,6 +297,24 @@ bool MainPanel::Scroll(double dx, double dy)
 
 
 
+// Reload any data files that have been changed, then re-apply the changes that
+// events have made to the player's universe.
+void MainPanel::ReloadData()
+{
+	int count = GameData::ReloadChangedData();
+	if(!count)
+		return;
+	
+	player.ReapplyChanges();
+	// Systems may have moved, so the map's fog of war must be regenerated, and
+	// everything must be drawn again using the new data.
+	FogShader::Redraw();
+	GetUI()->SetDirty();
+	Messages::Add("Reloaded " + to_string(count) + (count == 1 ? " data file." : " data files."));
+}
+
+
+
 void MainPanel::ShowScanDialog(const ShipEvent &event)
 {
 	shared_ptr<Ship> target = event.Target();
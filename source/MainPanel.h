@@ -52,6 +52,7 @@ protected:
 	
 	
 private:
+	void ReloadData();
 	void ShowScanDialog(const ShipEvent &event);
 	bool ShowHailPanel();
 	void StepEvents(bool &isActive);
@@ -102,6 +102,8 @@ void MapOutfitterPanel::Select(int index)
 		selected = list[index];
 		selectedInfo.Update(*selected, player);
 	}
+	// The system colors depend on which item is selected.
+	InvalidateColors();
 }
 
 
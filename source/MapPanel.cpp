@@ -121,6 +121,7 @@ void MapPanel::Draw()
 		11., 9., brightColor);
 	
 	++step;
+	UpdateCache();
 	DrawWormholes();
 	DrawTravelPlan();
 	DrawEscorts();
@@ -538,6 +539,14 @@ void MapPanel::Find(const string &name)
 
 
 
+// Make the system colors be recalculated the next time the map is drawn.
+void MapPanel::InvalidateColors()
+{
+	isCacheValid = false;
+}
+
+
+
 double MapPanel::Zoom() const
 {
 	return pow(1.5, player.MapZoom());
@@ -679,6 +688,65 @@ void MapPanel::DrawEscorts()
 
 
 void MapPanel::DrawWormholes()
+{
+	wormholeLines.Draw(center, Zoom());
+}
+
+
+
+void MapPanel::DrawLinks()
+{
+	linkLines.Draw(center, Zoom());
+}
+
+
+
+void MapPanel::DrawSystems()
+{
+	if(commodity == SHOW_GOVERNMENT)
+		closeGovernments.clear();
+	
+	// For every government that is drawn, keep track of how close it is to the
+	// center of the view. The four closest governments will be displayed in
+	// the key.
+	double zoom = Zoom();
+	for(const Node &node : nodes)
+		if(node.government)
+		{
+			double distance = (zoom * (node.system->Position() + center)).Length();
+			auto it = closeGovernments.find(node.government);
+			if(it == closeGovernments.end())
+				closeGovernments[node.government] = distance;
+			else
+				it->second = min(it->second, distance);
+		}
+	
+	// Draw the circles for the systems, colored based on the selected criterion,
+	// which may be government, services, or commodity prices.
+	systemRings.Draw(center, zoom);
+}
+
+
+
+// Rebuild the cached map geometry and system colors, if anything that they
+// depend on has changed since the last time.
+void MapPanel::UpdateCache()
+{
+	CacheKey key(commodity, player.GetDate().DaysSinceEpoch(), player.Flagship(),
+		player.VisitedVersion(), player.Missions().size(), player.AvailableJobs().size());
+	if(isCacheValid && key == cacheKey)
+		return;
+	isCacheValid = true;
+	cacheKey = key;
+	
+	CacheWormholes();
+	CacheLinks();
+	CacheSystems();
+}
+
+
+
+void MapPanel::CacheWormholes()
 {
 	// Keep track of what arrows and links need to be drawn.
 	set<pair<const System *, const System *>> arrowsToDraw;
@@ -708,42 +776,43 @@ void MapPanel::DrawWormholes()
 	static const double ARROW_RATIO = .3;
 	static const Angle LEFT(30.);
 	static const Angle RIGHT(-30.);
-	const double zoom = Zoom();
 	
+	wormholeLines.Clear();
 	for(const pair<const System *, const System *> &link : arrowsToDraw)
 	{
-		// Compute the start and end positions of the wormhole link.
-		Point from = zoom * (link.first->Position() + center);
-		Point to = zoom * (link.second->Position() + center);
+		// Compute the start and end positions of the wormhole link. The ends
+		// are offset by a fixed number of pixels from the systems.
+		Point from = link.first->Position();
+		Point to = link.second->Position();
 		Point offset = (from - to).Unit() * LINK_OFFSET;
-		from -= offset;
-		to += offset;
 		
 		// If an arrow is being drawn, the link will always be drawn too. Draw
 		// the link only for the first instance of it in this set.
 		if(link.first < link.second || !arrowsToDraw.count(make_pair(link.second, link.first)))
-			LineShader::Draw(from, to, LINK_WIDTH, wormholeDim);
+			wormholeLines.Add(from, -offset, to, offset, LINK_WIDTH, wormholeDim);
 		
-		// Compute the start and end positions of the arrow edges.
-		Point arrowStem = zoom * ARROW_LENGTH * offset;
+		// Compute the start and end positions of the arrow edges. Unlike the
+		// offset, the arrow scales with the zoom.
+		Point arrowStem = ARROW_LENGTH * offset;
 		Point arrowLeft = arrowStem - ARROW_RATIO * LEFT.Rotate(arrowStem);
 		Point arrowRight = arrowStem - ARROW_RATIO * RIGHT.Rotate(arrowStem);
 		
 		// Draw the arrowhead.
 		Point fromTip = from - arrowStem;
-		LineShader::Draw(from, fromTip, LINK_WIDTH, arrowColor);
-		LineShader::Draw(from - arrowLeft, fromTip, LINK_WIDTH, arrowColor);
-		LineShader::Draw(from - arrowRight, fromTip, LINK_WIDTH, arrowColor);
+		wormholeLines.Add(from, -offset, fromTip, -offset, LINK_WIDTH, arrowColor);
+		wormholeLines.Add(from - arrowLeft, -offset, fromTip, -offset, LINK_WIDTH, arrowColor);
+		wormholeLines.Add(from - arrowRight, -offset, fromTip, -offset, LINK_WIDTH, arrowColor);
 	}
 }
 
 
 
-void MapPanel::DrawLinks()
+void MapPanel::CacheLinks()
 {
 	// Draw the links between the systems.
 	const Color &closeColor = *GameData::Colors().Get("map link");
 	const Color &farColor = closeColor.Transparent(.5);
+	linkLines.Clear();
 	for(const auto &it : GameData::Systems())
 	{
 		const System *system = &it.second;
@@ -759,28 +828,24 @@ void MapPanel::DrawLinks()
 				if(!player.HasVisited(system) && !player.HasVisited(link))
 					continue;
 				
-				Point from = Zoom() * (system->Position() + center);
-				Point to = Zoom() * (link->Position() + center);
+				Point from = system->Position();
+				Point to = link->Position();
 				Point unit = (from - to).Unit() * LINK_OFFSET;
-				from -= unit;
-				to += unit;
 				
 				bool isClose = (system == playerSystem || link == playerSystem);
-				LineShader::Draw(from, to, LINK_WIDTH, isClose ? closeColor : farColor);
+				linkLines.Add(from, -unit, to, unit, LINK_WIDTH, isClose ? closeColor : farColor);
 			}
 	}
 }
 
 
 
-void MapPanel::DrawSystems()
+// Recalculate which systems are shown and what color they are.
+void MapPanel::CacheSystems()
 {
-	if(commodity == SHOW_GOVERNMENT)
-		closeGovernments.clear();
+	nodes.clear();
+	systemRings.Clear();
 	
-	// Draw the circles for the systems, colored based on the selected criterion,
-	// which may be government, services, or commodity prices.
-	double zoom = Zoom();
 	for(const auto &it : GameData::Systems())
 	{
 		const System &system = it.second;
@@ -791,9 +856,8 @@ void MapPanel::DrawSystems()
 		if(!player.HasSeen(&system) && &system != specialSystem)
 			continue;
 		
-		Point pos = zoom * (system.Position() + center);
-		
 		Color color = UninhabitedColor();
+		const Government *government = nullptr;
 		if(!player.HasVisited(&system))
 			color = UnexploredColor();
 		else if(system.IsInhabited(player.Flagship()) || commodity == SHOW_SPECIAL)
@@ -846,18 +910,8 @@ void MapPanel::DrawSystems()
 			}
 			else if(commodity == SHOW_GOVERNMENT)
 			{
-				const Government *gov = system.GetGovernment();
-				color = GovernmentColor(gov);
-				
-				// For every government that is draw, keep track of how close it
-				// is to the center of the view. The four closest governments
-				// will be displayed in the key.
-				double distance = pos.Length();
-				auto it = closeGovernments.find(gov);
-				if(it == closeGovernments.end())
-					closeGovernments[gov] = distance;
-				else
-					it->second = min(it->second, distance);
+				government = system.GetGovernment();
+				color = GovernmentColor(government);
 			}
 			else
 			{
@@ -892,7 +946,8 @@ void MapPanel::DrawSystems()
 			}
 		}
 		
-		RingShader::Draw(pos, OUTER, INNER, color);
+		nodes.push_back(Node{&system, color, government});
+		systemRings.Add(system.Position(), OUTER, INNER, color);
 	}
 }
 
@@ -950,7 +1005,11 @@ void MapPanel::DrawMissions()
 		{
 			int days = min(5, mission.Deadline() - player.GetDate()) + 1;
 			if(days > 0)
+			{
 				blink = (step % (10 * days) > 5 * days);
+				// Keep redrawing so the pointer keeps blinking.
+				SetDirty();
+			}
 		}
 		bool isSatisfied = IsSatisfied(player, mission);
 		DrawPointer(system, angle[system], blink ? black : isSatisfied ? currentColor : blockedColor, isSatisfied);
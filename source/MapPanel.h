@@ -17,16 +17,22 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Color.h"
 #include "DistanceMap.h"
+#include "LineShader.h"
 #include "Point.h"
+#include "RingShader.h"
 
+#include <cstddef>
 #include <map>
 #include <string>
+#include <tuple>
+#include <vector>
 
 class Angle;
 class Government;
 class Mission;
 class Planet;
 class PlayerInfo;
+class Ship;
 class System;
 
 
@@ -78,6 +84,9 @@ protected:
 	
 	void Select(const System *system);
 	void Find(const std::string &name);
+	// Make the system colors be recalculated the next time the map is drawn.
+	// This must be called if anything changes that SystemValue() depends on.
+	void InvalidateColors();
 	
 	double Zoom() const;
 	
@@ -113,6 +122,17 @@ protected:
 	std::map<const System *, bool> escortSystems;
 	
 	
+private:
+	// The color of each system that is shown on the map. For the government
+	// view, this also remembers which government each system belongs to.
+	class Node {
+	public:
+		const System *system;
+		Color color;
+		const Government *government;
+	};
+	
+	
 private:
 	void DrawTravelPlan();
 	// Indicate which other systems have player escorts.
@@ -121,10 +141,29 @@ private:
 	void DrawLinks();
 	// Draw systems in accordance to the set commodity color scheme.
 	void DrawSystems();
+	// The wormholes, links, and systems only change if the player learns
+	// about new systems or something else that they depend on changes, so
+	// their geometry is built once and then drawn in a single command.
+	void UpdateCache();
+	void CacheWormholes();
+	void CacheLinks();
+	void CacheSystems();
 	void DrawNames();
 	void DrawMissions();
 	void DrawPointer(const System *system, Angle &angle, const Color &color, bool bigger = false);
 	static void DrawPointer(Point position, Angle &angle, const Color &color, bool drawBack = true, bool bigger = false);
+	
+	
+private:
+	std::vector<Node> nodes;
+	LineShader::Batch wormholeLines;
+	LineShader::Batch linkLines;
+	RingShader::Batch systemRings;
+	// What the cache was built for: the coloring, the date, the flagship, the
+	// player's visited systems, and their missions and available jobs.
+	typedef std::tuple<int, int, const Ship *, int, size_t, size_t> CacheKey;
+	CacheKey cacheKey;
+	bool isCacheValid = false;
 };
 
 
@@ -97,6 +97,8 @@ void MapShipyardPanel::Select(int index)
 		selected = list[index];
 		selectedInfo.Update(*selected, player.StockDepreciation(), player.GetDate().DaysSinceEpoch());
 	}
+	// The system colors depend on which item is selected.
+	InvalidateColors();
 }
 
 
@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <limits>
 
 using namespace std;
@@ -198,6 +199,11 @@ namespace {
 	}
 	
 	
+	// No sprite should ever need more points than this in its outline. This is
+	// just to catch corrupted cache files.
+	const uint32_t MAX_POINTS = 1 << 20;
+	
+	
 	// Find the radius of the object.
 	double ComputeRadius(const vector<Point> &outline)
 	{
@@ -242,6 +248,49 @@ bool Mask::IsLoaded() const
 
 
 
+// Save this mask to a cache file. The outline points are always multiples of
+// 1/4 (see SmoothAndCenter()), so storing them as floats loses no precision.
+bool Mask::Write(FILE *file) const
+{
+	uint32_t count = outline.size();
+	if(fwrite(&count, sizeof(count), 1, file) != 1)
+		return false;
+	
+	vector<float> data;
+	data.reserve(2 * outline.size());
+	for(const Point &p : outline)
+	{
+		data.push_back(p.X());
+		data.push_back(p.Y());
+	}
+	return (fwrite(data.data(), sizeof(float), data.size(), file) == data.size());
+}
+
+
+
+// Restore a mask from a cache file.
+bool Mask::Read(FILE *file)
+{
+	outline.clear();
+	radius = 0.;
+	
+	uint32_t count = 0;
+	if(fread(&count, sizeof(count), 1, file) != 1 || count > MAX_POINTS)
+		return false;
+	
+	vector<float> data(2 * count);
+	if(fread(data.data(), sizeof(float), data.size(), file) != data.size())
+		return false;
+	
+	outline.reserve(count);
+	for(uint32_t i = 0; i < count; ++i)
+		outline.emplace_back(data[2 * i], data[2 * i + 1]);
+	radius = ComputeRadius(outline);
+	return true;
+}
+
+
+
 // Check if this mask intersects the given line segment (from sA to vA). If
 // it does, return the fraction of the way along the segment where the
 // intersection occurs. The sA should be relative to this object's center.
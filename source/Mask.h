@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Angle.h"
 #include "Point.h"
 
+#include <cstdio>
 #include <vector>
 
 class ImageBuffer;
@@ -38,6 +39,11 @@ public:
 	// Check whether a mask was successfully loaded.
 	bool IsLoaded() const;
 	
+	// Save this mask to a cache file, or restore it from one. Reading returns
+	// false if the file is truncated or does not contain a valid mask.
+	bool Write(FILE *file) const;
+	bool Read(FILE *file);
+	
 	// Check if this mask intersects the given line segment (from sA to vA). If
 	// it does, return the fraction of the way along the segment where the
 	// intersection occurs. The sA should be relative to this object's center.
@@ -74,6 +74,8 @@ MissionPanel::MissionPanel(PlayerInfo &player)
 	availableIt(player.AvailableJobs().begin()),
 	acceptedIt(player.AvailableJobs().empty() ? accepted.begin() : accepted.end())
 {
+	SetIsStatic(true);
+	
 	while(acceptedIt != accepted.end() && !acceptedIt->IsVisible())
 		++acceptedIt;
 	
@@ -112,6 +114,9 @@ MissionPanel::MissionPanel(const MapPanel &panel)
 	acceptedIt(player.AvailableJobs().empty() ? accepted.begin() : accepted.end()),
 	availableScroll(0), acceptedScroll(0), dragSide(0)
 {
+	// The map panel this is copied from may not be static.
+	SetIsStatic(true);
+	
 	// In this view, always color systems based on player reputation.
 	commodity = SHOW_REPUTATION;
 	
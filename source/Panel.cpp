@@ -72,6 +72,15 @@ bool Panel::IsInterruptible() const
 
 
 
+// Check if this panel must be drawn again, because it changes every frame
+// or because something it shows has changed since it was last drawn.
+bool Panel::NeedsRedraw() const
+{
+	return !isStatic || isDirty;
+}
+
+
+
 // Clear the list of clickable zones.
 void Panel::ClearZones()
 {
@@ -186,6 +195,22 @@ void Panel::SetInterruptible(bool set)
 }
 
 
+
+void Panel::SetIsStatic(bool set)
+{
+	isStatic = set;
+}
+
+
+
+// Mark this panel as needing to be drawn again, e.g. because it is in the
+// middle of an animation or the data it displays has changed.
+void Panel::SetDirty()
+{
+	isDirty = true;
+}
+
+
 	
 // Dim the background of this panel.
 void Panel::DrawBackdrop() const
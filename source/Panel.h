@@ -49,6 +49,9 @@ public:
 	bool TrapAllEvents();
 	// Check if this panel can be "interrupted" to return to the main menu.
 	bool IsInterruptible() const;
+	// Check if this panel must be drawn again, because it changes every frame
+	// or because something it shows has changed since it was last drawn.
+	bool NeedsRedraw() const;
 	
 	// Clear the list of clickable zones.
 	void ClearZones();
@@ -76,6 +79,13 @@ protected:
 	void SetIsFullScreen(bool set);
 	void SetTrapAllEvents(bool set);
 	void SetInterruptible(bool set);
+	// By default, a panel is redrawn every frame. A static panel only changes
+	// in response to user input, so once it has been drawn it is not drawn
+	// again until an event arrives or it calls SetDirty().
+	void SetIsStatic(bool set);
+	// Mark this panel as needing to be drawn again, e.g. because it is in the
+	// middle of an animation or the data it displays has changed.
+	void SetDirty();
 	
 	// Dim the background of this panel.
 	void DrawBackdrop() const;
@@ -118,6 +128,8 @@ private:
 	bool isFullScreen = false;
 	bool trapAllEvents = true;
 	bool isInterruptible = true;
+	bool isStatic = false;
+	bool isDirty = true;
 	
 	std::list<Zone> zones;
 	
@@ -46,6 +46,8 @@ PlanetPanel::PlanetPanel(PlayerInfo &player, function<void()> callback)
 	planet(*player.GetPlanet()), system(*player.GetSystem()),
 	ui(*GameData::Interfaces().Get("planet"))
 {
+	SetIsStatic(true);
+	
 	trading.reset(new TradingPanel(player));
 	bank.reset(new BankPanel(player));
 	spaceport.reset(new SpaceportPanel(player));
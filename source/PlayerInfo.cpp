@@ -388,6 +388,7 @@ void PlayerInfo::AddChanges(list<DataNode> &changes)
 			for(const System *neighbor : system->Neighbors())
 				seen.insert(neighbor);
 		}
+		++visitedVersion;
 	}
 	
 	// Only move the changes into my list if they are not already there.
@@ -397,6 +398,14 @@ void PlayerInfo::AddChanges(list<DataNode> &changes)
 
 
 
+// Apply all the stored changes again, e.g. after the game data is reloaded.
+void PlayerInfo::ReapplyChanges()
+{
+	AddChanges(dataChanges);
+}
+
+
+
 // Add an event that will happen at the given date.
 void PlayerInfo::AddEvent(const GameEvent &event, const Date &date)
 {
@@ -1696,6 +1705,7 @@ void PlayerInfo::Visit(const System *system)
 	seen.insert(system);
 	for(const System *neighbor : system->Neighbors())
 		seen.insert(neighbor);
+	++visitedVersion;
 }
 
 
@@ -1704,7 +1714,10 @@ void PlayerInfo::Visit(const System *system)
 void PlayerInfo::Visit(const Planet *planet)
 {
 	if(planet && !planet->TrueName().empty())
+	{
 		visitedPlanets.insert(planet);
+		++visitedVersion;
+	}
 }
 
 
@@ -1719,6 +1732,7 @@ void PlayerInfo::Unvisit(const System *system)
 	for(const StellarObject &object : system->Objects())
 		if(object.GetPlanet())
 			Unvisit(object.GetPlanet());
+	++visitedVersion;
 }
 
 
@@ -1729,6 +1743,16 @@ void PlayerInfo::Unvisit(const Planet *planet)
 		return;
 	
 	visitedPlanets.erase(planet);
+	++visitedVersion;
+}
+
+
+
+// Get a number that changes whenever the set of seen or visited systems or
+// visited planets changes.
+int PlayerInfo::VisitedVersion() const
+{
+	return visitedVersion;
 }
 
 
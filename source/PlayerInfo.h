@@ -72,6 +72,8 @@ public:
 	
 	// Apply the given changes and store them in the player's saved game file.
 	void AddChanges(std::list<DataNode> &changes);
+	// Apply all the stored changes again, e.g. after the game data is reloaded.
+	void ReapplyChanges();
 	// Add an event that will happen at the given date.
 	void AddEvent(const GameEvent &event, const Date &date);
 	
@@ -192,6 +194,9 @@ public:
 	// Mark a system and its planets as unvisited, even if visited previously.
 	void Unvisit(const System *system);
 	void Unvisit(const Planet *planet);
+	// Get a number that changes whenever the set of seen or visited systems or
+	// visited planets changes, so the map knows when to update its colors.
+	int VisitedVersion() const;
 	
 	// Access the player's travel plan.
 	bool HasTravelPlan() const;
@@ -304,6 +309,7 @@ private:
 	std::set<const System *> seen;
 	std::set<const System *> visitedSystems;
 	std::set<const Planet *> visitedPlanets;
+	int visitedVersion = 0;
 	std::vector<const System *> travelPlan;
 	const Planet *travelDestination = nullptr;
 	
@@ -17,6 +17,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Point.h"
 #include "Screen.h"
 #include "Shader.h"
+#include "VertexBatch.h"
 
 #include <stdexcept>
 
@@ -35,6 +36,14 @@ namespace {
 	
 	GLuint vao;
 	GLuint vbo;
+	
+	// The batch shader reads the ring position, size, and color from each
+	// vertex, and only draws complete rings.
+	Shader batchShader;
+	// Each vertex has ten floats: the ring position, the corner of the square
+	// containing the ring, the radius, the width, and the color.
+	const int VERTEX_FLOATS = 10;
+	const vector<VertexBatch::Attribute> LAYOUT = {{"position", 2}, {"vert", 2}, {"radius", 1}, {"width", 1}, {"color", 4}};
 }
 
 
@@ -112,6 +121,43 @@ void RingShader::Init()
 	// unbind the VBO and VAO
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
+	
+	static const char *batchVertexCode =
+		"uniform vec2 scale;\n"
+		"uniform vec2 center;\n"
+		"uniform float zoom;\n"
+		
+		"in vec2 position;\n"
+		"in vec2 vert;\n"
+		"in float radius;\n"
+		"in float width;\n"
+		"in vec4 color;\n"
+		"out vec2 coord;\n"
+		"out float fragRadius;\n"
+		"out float fragWidth;\n"
+		"out vec4 fragColor;\n"
+		
+		"void main() {\n"
+		"  coord = (radius + width) * vert;\n"
+		"  fragRadius = radius;\n"
+		"  fragWidth = width;\n"
+		"  fragColor = color;\n"
+		"  gl_Position = vec4(((position + center) * zoom + coord) * scale, 0, 1);\n"
+		"}\n";
+	
+	static const char *batchFragmentCode =
+		"in vec2 coord;\n"
+		"in float fragRadius;\n"
+		"in float fragWidth;\n"
+		"in vec4 fragColor;\n"
+		"out vec4 finalColor;\n"
+		
+		"void main() {\n"
+		"  float alpha = clamp(fragWidth - abs(length(coord) - fragRadius), 0, 1);\n"
+		"  finalColor = fragColor * alpha;\n"
+		"}\n";
+	
+	batchShader = Shader(batchVertexCode, batchFragmentCode);
 }
 
 
@@ -180,3 +226,41 @@ void RingShader::Unbind()
 	glBindVertexArray(0);
 	glUseProgram(0);
 }
+
+
+
+void RingShader::Batch::Clear()
+{
+	vertices.Clear();
+}
+
+
+
+void RingShader::Batch::Add(const Point &pos, float out, float in, const Color &color)
+{
+	float width = .5f * (1.f + out - in);
+	float radius = out - width;
+	
+	// Each ring is drawn as two triangles.
+	static const float CORNERS[6][2] = {{-1.f, -1.f}, {-1.f, 1.f}, {1.f, -1.f}, {-1.f, 1.f}, {1.f, -1.f}, {1.f, 1.f}};
+	const float *rgba = color.Get();
+	for(const float *corner : CORNERS)
+	{
+		const float vertex[VERTEX_FLOATS] = {
+			static_cast<float>(pos.X()), static_cast<float>(pos.Y()),
+			corner[0], corner[1], radius, width, rgba[0], rgba[1], rgba[2], rgba[3]};
+		vertices.Add(vertex, VERTEX_FLOATS);
+	}
+}
+
+
+
+// Draw the rings, with the given map position at the center of the screen
+// and the given zoom factor.
+void RingShader::Batch::Draw(const Point &center, double zoom) const
+{
+	if(!batchShader.Object())
+		throw runtime_error("RingShader: Draw() called before Init().");
+	
+	vertices.Draw(batchShader, LAYOUT, center, zoom);
+}
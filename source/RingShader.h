@@ -13,14 +13,35 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef RING_SHADER_H_
 #define RING_SHADER_H_
 
+#include "Point.h"
+#include "VertexBatch.h"
+
 class Color;
-class Point;
 
 
 
 // Class representing a shader that draws round "dots," either filled in or with
 // transparent centers (i.e. circles or rings).
 class RingShader {
+public:
+	// A set of complete rings that are stored in a vertex buffer, so that they
+	// can all be drawn with a single command. The center of each ring is in
+	// map coordinates, which move and scale along with the view, but the ring
+	// size is in screen pixels. The rings only need to be rebuilt when they
+	// change, not when the view is panned or zoomed.
+	class Batch {
+	public:
+		void Clear();
+		void Add(const Point &pos, float out, float in, const Color &color);
+		// Draw the rings, with the given map position at the center of the
+		// screen and the given zoom factor.
+		void Draw(const Point &center, double zoom) const;
+	
+	private:
+		VertexBatch vertices;
+	};
+	
+	
 public:
 	static void Init();
 	
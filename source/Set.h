@@ -13,75 +13,346 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef SET_H_
 #define SET_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 
 
 // Template representing a set of named objects of a given type, where you can
 // query it for a pointer to any object and it will return one, whether or not that
-// object has been loaded yet. (This allows cyclic pointers.)
+// object has been loaded yet. (This allows cyclic pointers.) Each object is
+// allocated separately, so pointers to it stay valid for as long as it is in
+// the set. Lookups by name go through a hash index, but iterating over the set
+// still visits the objects in alphabetical order.
 template<class Type>
 class Set {
 public:
+	typedef std::pair<const std::string, Type> value_type;
+	
+	// Iterator that visits the entries in order of their names.
+	template<class Value, class Base>
+	class Iterator : public std::iterator<std::bidirectional_iterator_tag, Value> {
+	public:
+		Iterator() = default;
+		explicit Iterator(Base it) : it(it) {}
+		// Allow converting a non-const iterator into a const one.
+		template<class OtherValue, class OtherBase>
+		Iterator(const Iterator<OtherValue, OtherBase> &other) : it(other.Position()) {}
+		
+		Value &operator*() const { return **it; }
+		Value *operator->() const { return &**it; }
+		Iterator &operator++() { ++it; return *this; }
+		Iterator operator++(int) { return Iterator(it++); }
+		Iterator &operator--() { --it; return *this; }
+		Iterator operator--(int) { return Iterator(it--); }
+		bool operator==(const Iterator &other) const { return it == other.it; }
+		bool operator!=(const Iterator &other) const { return it != other.it; }
+		
+		const Base &Position() const { return it; }
+	
+	private:
+		Base it;
+	};
+	typedef typename std::vector<std::unique_ptr<value_type>>::const_iterator Position;
+	typedef Iterator<value_type, Position> iterator;
+	typedef Iterator<const value_type, Position> const_iterator;
+	
+	// A handle resolves a name to an object once and then remembers it, so
+	// code that asks for the same object over and over (e.g. a particular
+	// effect every frame) does not have to hash the name each time. If the set
+	// is reverted, the handle looks the name up again the next time it is used.
+	class Handle {
+	public:
+		Handle(const Set<Type> &set, const std::string &name);
+		
+		const Type *Get() const;
+		const Type *operator->() const { return Get(); }
+		const Type &operator*() const { return *Get(); }
+	
+	private:
+		const Set<Type> *set;
+		std::string name;
+		mutable const Type *object = nullptr;
+		mutable size_t generation = 0;
+	};
+	
+	
+public:
+	Set() = default;
+	Set(const Set<Type> &other);
+	Set<Type> &operator=(const Set<Type> &other);
+	
 	// Allow non-const access to the owner of this set; it can hand off only
-	// const references to avoid anyone else modifying the objects.
-	Type *Get(const std::string &name) { return &data[name]; }
-	const Type *Get(const std::string &name) const { return &data[name]; }
+	// const references to avoid anyone else modifying the objects. If changes
+	// are being recorded, non-const access assumes the object will be modified.
+	Type *Get(const std::string &name);
+	const Type *Get(const std::string &name) const { return &Insert(name)->second; }
 	// If an item already exists in this set, get it. Otherwise, return a null
 	// pointer rather than creating the item.
 	const Type *Find(const std::string &name) const;
 	
-	bool Has(const std::string &name) const { return data.count(name); }
+	bool Has(const std::string &name) const { return Lookup(name, std::hash<std::string>()(name)); }
+	
+	iterator begin() { return iterator(order.begin()); }
+	const_iterator begin() const { return const_iterator(order.begin()); }
+	iterator end() { return iterator(order.end()); }
+	const_iterator end() const { return const_iterator(order.end()); }
 	
-	typename std::map<std::string, Type>::iterator begin() { return data.begin(); }
-	typename std::map<std::string, Type>::const_iterator begin() const { return data.begin(); }
-	typename std::map<std::string, Type>::iterator end() { return data.end(); }
-	typename std::map<std::string, Type>::const_iterator end() const { return data.end(); }
+	int size() const { return order.size(); }
 	
-	int size() const { return data.size(); }
-	// Remove any objects in this set that are not in the given set, and for
-	// those that are in the given set, revert to their contents.
-	void Revert(const Set<Type> &other);
+	// Begin recording changes to this set. From now on, the first time an
+	// object is accessed through the non-const Get() its current state is saved,
+	// and any objects that are created are remembered.
+	void Snapshot();
+	// Undo all the changes that have been recorded since Snapshot() was called:
+	// remove any objects that have been created, and restore the saved state of
+	// any that were modified. Recording continues afterwards. This returns true
+	// if anything was changed. Removed objects are not deleted, so pointers to
+	// them remain valid, and if an object with the same name is created again
+	// later it will be at the same address.
+	bool Revert();
 	
 	
 private:
-	mutable std::map<std::string, Type> data;
+	// Each slot in the hash index remembers the full hash of the name, so that
+	// probing only has to compare strings whose hashes match.
+	class Slot {
+	public:
+		size_t hash = 0;
+		value_type *entry = nullptr;
+	};
+	
+	
+private:
+	value_type *Lookup(const std::string &name, size_t hash) const;
+	value_type *Insert(const std::string &name) const;
+	// Add the given entry to the hash index, without checking for duplicates.
+	void Index(value_type *entry, size_t hash) const;
+	void Reindex() const;
+	
+	
+private:
+	// All the entries in this set, sorted by name.
+	mutable std::vector<std::unique_ptr<value_type>> order;
+	// Open addressing hash index with linear probing. The number of slots is
+	// always a power of two, and at most half of them are in use.
+	mutable std::vector<Slot> slots;
+	// If changes are being recorded, this holds the saved state of each entry
+	// that has been modified. Entries that have been created since the snapshot
+	// map to a null pointer instead.
+	bool isRecording = false;
+	mutable std::map<value_type *, std::unique_ptr<Type>> journal;
+	// Entries that were removed by Revert(), reset to their default state.
+	mutable std::map<std::string, std::unique_ptr<value_type>> removed;
+	// This is incremented whenever entries are removed, so handles know they
+	// must look up their objects again.
+	size_t generation = 0;
 };
 
 
 
+template <class Type>
+Set<Type>::Handle::Handle(const Set<Type> &set, const std::string &name)
+	: set(&set), name(name)
+{
+}
+
+
+
+template <class Type>
+const Type *Set<Type>::Handle::Get() const
+{
+	if(!object || generation != set->generation)
+	{
+		object = set->Get(name);
+		generation = set->generation;
+	}
+	return object;
+}
+
+
+
+template <class Type>
+Set<Type>::Set(const Set<Type> &other)
+{
+	*this = other;
+}
+
+
+
+template <class Type>
+Set<Type> &Set<Type>::operator=(const Set<Type> &other)
+{
+	if(this == &other)
+		return *this;
+	
+	order.clear();
+	journal.clear();
+	removed.clear();
+	isRecording = false;
+	order.reserve(other.order.size());
+	for(const std::unique_ptr<value_type> &entry : other.order)
+		order.emplace_back(new value_type(*entry));
+	Reindex();
+	++generation;
+	return *this;
+}
+
+
+
 template <class Type>
 const Type *Set<Type>::Find(const std::string &name) const
 {
-	auto it = data.find(name);
-	return (it == data.end() ? nullptr : &it->second);
+	value_type *entry = Lookup(name, std::hash<std::string>()(name));
+	return (entry ? &entry->second : nullptr);
 }
 
 
 
 template <class Type>
-void Set<Type>::Revert(const Set<Type> &other)
+Type *Set<Type>::Get(const std::string &name)
 {
-	auto it = data.begin();
-	auto oit = other.data.begin();
+	value_type *entry = Insert(name);
+	if(isRecording && !journal.count(entry))
+		journal[entry].reset(new Type(entry->second));
+	return &entry->second;
+}
+
+
+
+template <class Type>
+void Set<Type>::Snapshot()
+{
+	isRecording = true;
+	journal.clear();
+}
+
+
+
+template <class Type>
+bool Set<Type>::Revert()
+{
+	if(journal.empty())
+		return false;
 	
-	while(it != data.end())
+	// If this is an entry that was modified, copy the state we are reverting
+	// to. Otherwise, it was created after the snapshot and must be removed.
+	bool isErased = false;
+	for(auto &it : journal)
 	{
-		if(oit == other.data.end() || it->first < oit->first)
-			it = data.erase(it);
-		else if(it->first == oit->first)
+		if(it.second)
+			it.first->second = *it.second;
+		else
 		{
-			// If this is an entry that is in the set we are reverting to, copy
-			// the state we are reverting to.
-			it->second = oit->second;
-			++it;
-			++oit;
+			it.first->second = Type();
+			isErased = true;
 		}
-		
-		// There should never be a case when an entry in the set we are
-		// reverting to has a name that is not also in this set.
 	}
+	if(isErased)
+	{
+		// Set aside the removed entries instead of deleting them, because other
+		// objects may still be pointing to them.
+		for(std::unique_ptr<value_type> &entry : order)
+		{
+			auto it = journal.find(entry.get());
+			if(it != journal.end() && !it->second)
+				removed[entry->first] = std::move(entry);
+		}
+		order.erase(std::remove(order.begin(), order.end(), nullptr), order.end());
+		Reindex();
+		++generation;
+	}
+	journal.clear();
+	return true;
+}
+
+
+
+template <class Type>
+typename Set<Type>::value_type *Set<Type>::Lookup(const std::string &name, size_t hash) const
+{
+	if(slots.empty())
+		return nullptr;
+	
+	size_t mask = slots.size() - 1;
+	for(size_t i = hash & mask; slots[i].entry; i = (i + 1) & mask)
+		if(slots[i].hash == hash && slots[i].entry->first == name)
+			return slots[i].entry;
+	return nullptr;
+}
+
+
+
+template <class Type>
+typename Set<Type>::value_type *Set<Type>::Insert(const std::string &name) const
+{
+	size_t hash = std::hash<std::string>()(name);
+	value_type *entry = Lookup(name, hash);
+	if(entry)
+		return entry;
+	
+	// This is a new entry. Keep the list of entries in sorted order, so that
+	// iterating over them works the same way as iterating over a std::map.
+	auto it = std::lower_bound(order.begin(), order.end(), name,
+		[](const std::unique_ptr<value_type> &entry, const std::string &name)
+		{
+			return entry->first < name;
+		});
+	// If an entry with this name was removed by Revert(), bring it back rather
+	// than allocating a new one.
+	auto rit = removed.find(name);
+	if(rit != removed.end())
+	{
+		entry = rit->second.release();
+		removed.erase(rit);
+	}
+	else
+		entry = new value_type(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple());
+	order.emplace(it, entry);
+	if(isRecording)
+		journal[entry];
+	
+	// Grow the index if it is more than half full.
+	if(2 * order.size() > slots.size())
+		Reindex();
+	else
+		Index(entry, hash);
+	return entry;
+}
+
+
+
+template <class Type>
+void Set<Type>::Index(value_type *entry, size_t hash) const
+{
+	size_t mask = slots.size() - 1;
+	size_t i = hash & mask;
+	while(slots[i].entry)
+		i = (i + 1) & mask;
+	slots[i].hash = hash;
+	slots[i].entry = entry;
+}
+
+
+
+template <class Type>
+void Set<Type>::Reindex() const
+{
+	size_t size = 16;
+	while(size < 2 * order.size())
+		size *= 2;
+	
+	slots.assign(size, Slot());
+	for(const std::unique_ptr<value_type> &entry : order)
+		Index(entry.get(), std::hash<std::string>()(entry->first));
 }
 
 
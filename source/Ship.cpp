@@ -881,11 +881,20 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 
 	// Handle ionization effects, etc.
 	if(ionization)
-		CreateSparks(visuals, "ion spark", ionization * .1);
+	{
+		static const Set<Effect>::Handle ionSpark(GameData::Effects(), "ion spark");
+		CreateSparks(visuals, ionSpark.Get(), ionization * .1);
+	}
 	if(disruption)
-		CreateSparks(visuals, "disruption spark", disruption * .1);
+	{
+		static const Set<Effect>::Handle disruptionSpark(GameData::Effects(), "disruption spark");
+		CreateSparks(visuals, disruptionSpark.Get(), disruption * .1);
+	}
 	if(slowness)
-		CreateSparks(visuals, "slowing spark", slowness * .1);
+	{
+		static const Set<Effect>::Handle slowingSpark(GameData::Effects(), "slowing spark");
+		CreateSparks(visuals, slowingSpark.Get(), slowness * .1);
+	}
 	// Jettisoned cargo effects (only for ships in the current system).
 	if(!jettisoned.empty() && !forget)
 	{
@@ -940,7 +949,8 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		{
 			if(!forget)
 			{
-				const Effect *effect = GameData::Effects().Get("smoke");
+				static const Set<Effect>::Handle smoke(GameData::Effects(), "smoke");
+				const Effect *effect = smoke.Get();
 				double size = Width() + Height();
 				double scale = .03 * size + .5;
 				double radius = .2 * size;
@@ -1003,7 +1013,10 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		// Create the particle effects for the jump drive. This may create 100
 		// or more particles per ship per turn at the peak of the jump.
 		if(isUsingJumpDrive && !forget)
-			CreateSparks(visuals, "jump drive", hyperspaceCount * Width() * Height() * .000006);
+		{
+			static const Set<Effect>::Handle jumpDrive(GameData::Effects(), "jump drive");
+			CreateSparks(visuals, jumpDrive.Get(), hyperspaceCount * Width() * Height() * .000006);
+		}
 		
 		if(hyperspaceCount == HYPER_C)
 		{
@@ -2966,7 +2979,7 @@ void Ship::CreateExplosion(vector<Visual> &visuals, bool spread)
 
 
 // Place a "spark" effect, like ionization or disruption.
-void Ship::CreateSparks(vector<Visual> &visuals, const string &name, double amount)
+void Ship::CreateSparks(vector<Visual> &visuals, const Effect *effect, double amount)
 {
 	if(forget)
 		return;
@@ -2974,7 +2987,6 @@ void Ship::CreateSparks(vector<Visual> &visuals, const string &name, double amou
 	// Limit the number of sparks, depending on the size of the sprite.
 	amount = min(amount, Width() * Height() * .0006);
 	
-	const Effect *effect = GameData::Effects().Get(name);
 	while(true)
 	{
 		amount -= Random::Real();
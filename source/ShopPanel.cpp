@@ -55,6 +55,7 @@ ShopPanel::ShopPanel(PlayerInfo &player, bool isOutfitter)
 		playerShips.insert(playerShip);
 	SetIsFullScreen(true);
 	SetInterruptible(false);
+	SetIsStatic(true);
 }
 
 
@@ -80,6 +81,7 @@ void ShopPanel::Step()
 		// Details are in view.
 		else
 			scrollDetailsIntoView = false;
+		SetDirty();
 	}
 }
 
@@ -102,6 +104,9 @@ void ShopPanel::Draw()
 	
 	shipInfo.DrawTooltips();
 	outfitInfo.DrawTooltips();
+	// A tooltip only appears once the mouse has hovered over it for a while.
+	if(shipInfo.IsAnimating() || outfitInfo.IsAnimating())
+		SetDirty();
 	
 	if(!warningType.empty())
 	{
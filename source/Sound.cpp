@@ -37,7 +37,7 @@ namespace {
 
 
 
-bool Sound::Load(const string &path)
+bool Sound::Load(const string &path, bool hasDevice)
 {
 	if(path.length() < 5 || path.compare(path.length() - 4, 4, ".wav"))
 		return false;
@@ -56,9 +56,15 @@ bool Sound::Load(const string &path)
 	if(fread(&data[0], 1, bytes, in) != bytes)
 		return false;
 	
-	if(!buffer)
-		alGenBuffers(1, &buffer);
-	alBufferData(buffer, AL_FORMAT_MONO16, &data.front(), bytes, frequency);
+	if(hasDevice)
+	{
+		if(!buffer)
+			alGenBuffers(1, &buffer);
+		alBufferData(buffer, AL_FORMAT_MONO16, &data.front(), bytes, frequency);
+	}
+	// Each sample is two bytes.
+	duration = frequency ? .5 * bytes / frequency : 0.;
+	isLoaded = true;
 	
 	return true;
 }
@@ -79,6 +85,39 @@ bool Sound::IsLooping() const
 
 
 
+// Check if this sound was loaded successfully. Without an audio device, a
+// sound can be loaded even though it has no buffer.
+bool Sound::IsLoaded() const
+{
+	return isLoaded;
+}
+
+
+
+// Check if this sound is still waiting to be loaded. Once it is taken off
+// the load queue, this is false whether or not it loaded successfully.
+bool Sound::IsQueued() const
+{
+	return isQueued;
+}
+
+
+
+void Sound::SetQueued(bool queued)
+{
+	isQueued = queued;
+}
+
+
+
+// Get the length of the sound, in seconds.
+double Sound::Duration() const
+{
+	return duration;
+}
+
+
+
 namespace {
 	// Read a WAV header, and return the size of the data, in bytes. If the file
 	// is an unsupported format (anything but little-endian 16-bit PCM at 44100 HZ),
@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef SOUND_H_
 #define SOUND_H_
 
+#include <atomic>
 #include <string>
 
 
@@ -21,15 +22,31 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 // whether it is looping (ends in '~') or not.
 class Sound {
 public:
-	bool Load(const std::string &path);
+	// Load the sound from the given file. If there is no audio device, the file
+	// is still read and checked, but it is not handed off to OpenAL.
+	bool Load(const std::string &path, bool hasDevice = true);
 	
 	unsigned Buffer() const;
 	bool IsLooping() const;
+	// Check if this sound was loaded successfully. Without an audio device, a
+	// sound can be loaded even though it has no buffer.
+	bool IsLoaded() const;
+	// Check if this sound is still waiting to be loaded. Once it is taken off
+	// the load queue, this is false whether or not it loaded successfully.
+	bool IsQueued() const;
+	void SetQueued(bool queued);
+	// Get the length of the sound, in seconds.
+	double Duration() const;
 	
 	
 private:
 	unsigned buffer = 0;
+	double duration = 0.;
 	bool isLooped = false;
+	// Sounds are loaded in other threads, so this is set only once the rest of
+	// the sound is ready to be played.
+	std::atomic<bool> isLoaded{false};
+	std::atomic<bool> isQueued{false};
 };
 
 
@@ -31,6 +31,7 @@ SpaceportPanel::SpaceportPanel(PlayerInfo &player)
 	: player(player)
 {
 	SetTrapAllEvents(false);
+	SetIsStatic(true);
 	
 	text.SetFont(FontSet::Get(14));
 	text.SetAlignment(WrappedText::JUSTIFIED);
@@ -23,6 +23,66 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 using namespace std;
 
+namespace {
+	// Each atlas texture has this many layers. Sprites with more frames than
+	// this are never put in an atlas.
+	const int ATLAS_LAYERS = 64;
+	// Only sprites this size or smaller (in 1x pixels) are put in an atlas.
+	const int MAX_ATLAS_SIZE = 128;
+	
+	// An atlas texture whose layers all have the same size.
+	class AtlasPage {
+	public:
+		uint32_t texture;
+		int width;
+		int height;
+		int used;
+	};
+	vector<AtlasPage> pages;
+	
+	// Check if the sprite with the given name is one that is drawn in batches.
+	bool IsBatched(const string &name)
+	{
+		return !name.compare(0, 7, "effect/") || !name.compare(0, 11, "projectile/");
+	}
+	
+	// Get the layer size to use for an image of the given size.
+	int LayerSize(int size)
+	{
+		int result = 8;
+		while(result < size)
+			result *= 2;
+		return result;
+	}
+	
+	// Find an atlas page with room for the given number of layers of the given
+	// size, or create a new one if none of them has room.
+	AtlasPage &FindPage(int width, int height, int layers)
+	{
+		for(AtlasPage &page : pages)
+			if(page.width == width && page.height == height && page.used + layers <= ATLAS_LAYERS)
+				return page;
+		
+		pages.push_back(AtlasPage{0, width, height, 0});
+		AtlasPage &page = pages.back();
+		glGenTextures(1, &page.texture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		
+		// Allocate all the layers at once. They must start out transparent,
+		// because the part of each layer around the image is drawn too when the
+		// texture coordinates are interpolated at the image's edge.
+		vector<uint32_t> empty(width * height * ATLAS_LAYERS, 0);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, ATLAS_LAYERS,
+			0, GL_BGRA, GL_UNSIGNED_BYTE, empty.data());
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		return page;
+	}
+}
+
 
 
 Sprite::Sprite(const string &name)
@@ -39,20 +99,28 @@ const string &Sprite::Name() const
 
 
 
-// Upload the given frames. The given buffer will be cleared afterwards.
-void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
+// Upload the given frames. The given buffer will be cleared afterwards. If
+// no texture should be created yet (because the sprite is only loaded when
+// it is needed), just record the sprite's dimensions.
+void Sprite::AddFrames(ImageBuffer &buffer, bool is2x, bool createTexture)
 {
 	// Do nothing if the buffer is empty.
 	if(!buffer.Pixels())
 		return;
 	
 	// If this is the 1x image, its dimensions determine the sprite's size.
-	if(!is2x)
+	// If the sprite is being reloaded, it already has the right size.
+	if(!is2x && !frames)
 	{
 		width = buffer.Width();
 		height = buffer.Height();
 		frames = buffer.Frames();
 	}
+	if(!createTexture)
+	{
+		buffer.Clear();
+		return;
+	}
 	
 	// Check whether this sprite is large enough to require size reduction.
 	if(Preferences::Has("Reduce large graphics") && buffer.Width() * buffer.Height() >= 1000000)
@@ -75,6 +143,11 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 	
 	// Unbind the texture.
 	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	textureBytes += sizeof(uint32_t) * buffer.Width() * buffer.Height() * buffer.Frames();
+	
+	// Small sprites that are drawn in batches also go into an atlas.
+	if(IsBatched(name))
+		AddToAtlas(buffer, is2x);
 	
 	// Free the ImageBuffer memory.
 	buffer.Clear();
@@ -83,25 +156,49 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 
 
 // Move the given masks into this sprite's internal storage. The given
-// vector will be cleared.
+// vector will be cleared. If the sprite is being reloaded, it keeps the
+// masks it already has, because other threads may be using them.
 void Sprite::AddMasks(vector<Mask> &masks)
 {
-	this->masks.swap(masks);
+	if(this->masks.empty())
+		this->masks.swap(masks);
 	masks.clear();
 }
 
 
 
-// Free up all textures loaded for this sprite.
+// Free up all textures loaded for this sprite. Its dimensions and masks are
+// kept, so it can still be used for everything except drawing.
 void Sprite::Unload()
 {
 	glDeleteTextures(2, texture);
 	texture[0] = texture[1] = 0;
-	
-	masks.clear();
-	width = 0.f;
-	height = 0.f;
-	frames = 0;
+	textureBytes = 0;
+}
+
+
+
+// Check whether the textures for this sprite are loaded.
+bool Sprite::IsLoaded() const
+{
+	return texture[0];
+}
+
+
+
+// Get how much memory this sprite's textures take up.
+size_t Sprite::TextureBytes() const
+{
+	return textureBytes;
+}
+
+
+
+// Check whether this sprite's texture has been asked for since the last
+// time this was called.
+bool Sprite::WasUsed() const
+{
+	return isUsed.exchange(false, memory_order_relaxed);
 }
 
 
@@ -150,11 +247,21 @@ uint32_t Sprite::Texture() const
 // Get the index of the texture for the given high DPI mode.
 uint32_t Sprite::Texture(bool isHighDPI) const
 {
+	isUsed.store(true, memory_order_relaxed);
 	return (isHighDPI && texture[1]) ? texture[1] : texture[0];
 }
 
 
 
+// Get where this sprite is in a texture atlas, if it is in one, for the
+// same resolution that Texture() would return.
+const Sprite::AtlasRegion &Sprite::Atlas(bool isHighDPI) const
+{
+	return atlas[isHighDPI && texture[1]];
+}
+
+
+
 // Get the collision mask for the given frame of the animation.
 const Mask &Sprite::GetMask(int frame) const
 {
@@ -165,3 +272,53 @@ const Mask &Sprite::GetMask(int frame) const
 	// Assume that if a masks array exists, it has the right number of frames.
 	return masks[frame % masks.size()];
 }
+
+
+
+void Sprite::AddToAtlas(const ImageBuffer &buffer, bool is2x)
+{
+	int maxSize = MAX_ATLAS_SIZE * (1 + is2x);
+	if(buffer.Width() > maxSize || buffer.Height() > maxSize || buffer.Frames() > ATLAS_LAYERS)
+		return;
+	
+	// If this sprite is being reloaded, it already has layers reserved for it
+	// (unloading a sprite only frees its own textures). Atlas layers are never
+	// freed, so reusing them is what keeps the atlases from growing each time.
+	int layerWidth = LayerSize(buffer.Width());
+	int layerHeight = LayerSize(buffer.Height());
+	AtlasRegion &region = atlas[is2x];
+	if(!region.texture)
+	{
+		AtlasPage &page = FindPage(layerWidth, layerHeight, buffer.Frames());
+		region.texture = page.texture;
+		region.layer = page.used;
+		region.scale = Point(
+			buffer.Width() / static_cast<double>(page.width),
+			buffer.Height() / static_cast<double>(page.height));
+		page.used += buffer.Frames();
+	}
+	
+	// Linear filtering at the right and bottom edges of the image reads half a
+	// texel beyond it. Add a one-texel gutter there that repeats the edge of
+	// the image, so it looks the same as it would in a texture of its own with
+	// GL_CLAMP_TO_EDGE. (If the image fills the layer, the page's own clamping
+	// takes care of that.)
+	int width = min(buffer.Width() + 1, layerWidth);
+	int height = min(buffer.Height() + 1, layerHeight);
+	vector<uint32_t> padded(width * height * buffer.Frames());
+	for(int frame = 0; frame < buffer.Frames(); ++frame)
+		for(int y = 0; y < height; ++y)
+		{
+			const uint32_t *in = buffer.Begin(min(y, buffer.Height() - 1), frame);
+			uint32_t *out = &padded[(frame * height + y) * width];
+			copy(in, in + buffer.Width(), out);
+			if(width > buffer.Width())
+				out[buffer.Width()] = in[buffer.Width() - 1];
+		}
+	
+	glBindTexture(GL_TEXTURE_2D_ARRAY, region.texture);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, region.layer, // target, mipmap level, x, y, z offset,
+		width, height, buffer.Frames(), // width, height, depth,
+		GL_BGRA, GL_UNSIGNED_BYTE, padded.data()); // input format, data type, data.
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
@@ -16,6 +16,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Mask.h"
 #include "Point.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -31,18 +33,46 @@ class ImageBuffer;
 // sheets, but with modern graphics cards it will not matter much and it makes
 // working with the graphics a lot simpler.
 class Sprite {
+public:
+	// Small sprites that are drawn in batches (effects and projectiles) are
+	// also copied into a shared texture atlas, so that many different sprites
+	// can be drawn with a single draw command. Each frame of the sprite takes
+	// up one layer of the atlas, with the image in the layer's top left corner.
+	class AtlasRegion {
+	public:
+		// The atlas texture, or 0 if this sprite is not in an atlas.
+		uint32_t texture = 0;
+		// The layer that holds the first frame of this sprite.
+		int layer = 0;
+		// The texture coordinates of the bottom right corner of the image.
+		Point scale;
+	};
+	
+	
 public:
 	explicit Sprite(const std::string &name = "");
 	
 	const std::string &Name() const;
 	
-	// Upload the given frames. The given buffer will be cleared afterwards.
-	void AddFrames(ImageBuffer &buffer, bool is2x);
+	// Upload the given frames. The given buffer will be cleared afterwards. If
+	// no texture should be created yet (because the sprite is only loaded when
+	// it is needed), just record the sprite's dimensions.
+	void AddFrames(ImageBuffer &buffer, bool is2x, bool createTexture = true);
 	// Move the given masks into this sprite's internal storage. The given
-	// vector will be cleared.
+	// vector will be cleared. If the sprite is being reloaded, it keeps the
+	// masks it already has, because other threads may be using them.
 	void AddMasks(std::vector<Mask> &masks);
-	// Free up all textures loaded for this sprite.
+	// Free up all textures loaded for this sprite. Its dimensions and masks are
+	// kept, so it can still be used for everything except drawing.
 	void Unload();
+	// Check whether the textures for this sprite are loaded, and how much
+	// memory they take up.
+	bool IsLoaded() const;
+	size_t TextureBytes() const;
+	// Check whether this sprite's texture has been asked for since the last
+	// time this was called. This is used to decide which sprites to load or
+	// unload, for sprites that are only loaded when needed.
+	bool WasUsed() const;
 	
 	// Image dimensions, in pixels.
 	float Width() const;
@@ -59,14 +89,24 @@ public:
 	// setting or specifying it manually.
 	uint32_t Texture() const;
 	uint32_t Texture(bool isHighDPI) const;
+	// Get where this sprite is in a texture atlas, if it is in one, for the
+	// same resolution that Texture() would return.
+	const AtlasRegion &Atlas(bool isHighDPI) const;
 	// Get the collision mask for the given frame of the animation.
 	const Mask &GetMask(int frame = 0) const;
 	
 	
+private:
+	void AddToAtlas(const ImageBuffer &buffer, bool is2x);
+	
+	
 private:
 	std::string name;
 	
 	uint32_t texture[2] = {0, 0};
+	size_t textureBytes = 0;
+	mutable std::atomic<bool> isUsed{false};
+	AtlasRegion atlas[2];
 	std::vector<Mask> masks;
 	
 	float width = 0.f;
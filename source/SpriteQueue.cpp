@@ -19,14 +19,25 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "SpriteSet.h"
 
 #include <algorithm>
+#include <chrono>
 #include <functional>
+#include <limits>
 
 using namespace std;
 
+namespace {
+	// Only this many image sets can be waiting to be uploaded at once. If the
+	// main thread falls behind, the worker threads wait for it to catch up.
+	const size_t MAX_WAITING = 256;
+	// Maximum time to spend uploading textures in each frame, in seconds.
+	const double UPLOAD_TIME = .008;
+}
+
 
 
 // Constructor, which allocates worker threads.
 SpriteQueue::SpriteQueue()
+	: added(0), toLoad(MAX_WAITING), completed(0)
 {
 	threads.resize(max(4u, thread::hardware_concurrency()));
 	for(thread &t : threads)
@@ -50,7 +61,7 @@ SpriteQueue::~SpriteQueue()
 
 
 // Add a sprite to load.
-void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
+void SpriteQueue::Add(const shared_ptr<ImageSet> &images, Priority priority)
 {
 	{
 		lock_guard<mutex> lock(readMutex);
@@ -58,7 +69,8 @@ void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
 		if(added < 0)
 			return;
 		
-		toRead.push(images);
+		toRead[priority].push_back(images);
+		waiting[images->Name()] = priority;
 		++added;
 	}
 	readCondition.notify_one();
@@ -66,10 +78,32 @@ void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
 
 
 
-// Unload the texture for the given sprite (to free up memory).
+// If the given sprite is still waiting to be read, move it up to the given
+// priority class (if that is higher than its current one).
+void SpriteQueue::Prioritize(const string &name, Priority priority)
+{
+	lock_guard<mutex> lock(readMutex);
+	auto it = waiting.find(name);
+	if(it == waiting.end() || it->second <= priority)
+		return;
+	
+	deque<shared_ptr<ImageSet>> &from = toRead[it->second];
+	for(auto sit = from.begin(); sit != from.end(); ++sit)
+		if((*sit)->Name() == name)
+		{
+			toRead[priority].push_back(*sit);
+			from.erase(sit);
+			break;
+		}
+	it->second = priority;
+}
+
+
+
+// Unload the texture for the given sprite (to free up memory). This must
+// only be called from the main thread.
 void SpriteQueue::Unload(const string &name)
 {
-	unique_lock<mutex> lock(loadMutex);
 	toUnload.push(name);
 }
 
@@ -78,8 +112,7 @@ void SpriteQueue::Unload(const string &name)
 // Find out our percent completion.
 double SpriteQueue::Progress()
 {
-	unique_lock<mutex> lock(loadMutex);
-	return DoLoad(lock);
+	return DoLoad(UPLOAD_TIME);
 }
 
 
@@ -90,15 +123,16 @@ void SpriteQueue::Finish()
 	// Loop until done loading.
 	while(true)
 	{
-		unique_lock<mutex> lock(loadMutex);
-		
 		// Load whatever is already queued up for loading.
-		if(DoLoad(lock) == 1.)
+		if(DoLoad(numeric_limits<double>::infinity()) == 1.)
 			break;
 		
 		// We still have sprites to upload, but none of them have been read from
-		// disk yet. Wait until one arrives.
-		loadCondition.wait(lock);
+		// disk yet. Wait until one arrives. The worker threads do not lock the
+		// mutex before notifying this thread, so a notification might be missed;
+		// that is why this only waits for a short time before checking again.
+		unique_lock<mutex> lock(loadMutex);
+		loadCondition.wait_for(lock, chrono::milliseconds(10));
 	}
 }
 
@@ -116,12 +150,11 @@ void SpriteQueue::operator()()
 			// "added" to -1.
 			if(added < 0)
 				return;
-			if(toRead.empty())
-				break;
 			
 			// Extract the one item we should work on reading right now.
-			shared_ptr<ImageSet> imageSet = toRead.front();
-			toRead.pop();
+			shared_ptr<ImageSet> imageSet = NextToRead();
+			if(!imageSet)
+				break;
 			
 			// It's now safe to add to the lists.
 			lock.unlock();
@@ -129,10 +162,14 @@ void SpriteQueue::operator()()
 			// Load the sprite.
 			imageSet->Load();
 			
+			// The texture must be uploaded to OpenGL in the main thread. If
+			// too many sprites are already waiting for that, wait until there
+			// is room, unless the queue is being destroyed.
+			while(!toLoad.Push(imageSet))
 			{
-				// The texture must be uploaded to OpenGL in the main thread.
-				unique_lock<mutex> lock(loadMutex);
-				toLoad.push(imageSet);
+				if(added < 0)
+					return;
+				this_thread::sleep_for(chrono::milliseconds(1));
 			}
 			loadCondition.notify_one();
 			
@@ -145,38 +182,49 @@ void SpriteQueue::operator()()
 
 
 
-double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
+// Upload images until there are none left or the given number of seconds
+// have passed. At least one image is uploaded if any are ready.
+double SpriteQueue::DoLoad(double timeBudget)
 {
 	while(!toUnload.empty())
 	{
-		Sprite *sprite = SpriteSet::Modify(toUnload.front());
+		SpriteSet::Modify(toUnload.front())->Unload();
 		toUnload.pop();
-		
-		lock.unlock();
-		sprite->Unload();
-		lock.lock();
 	}
 	
-	for(int i = 0; !toLoad.empty() && i < 100; ++i)
+	auto start = chrono::steady_clock::now();
+	shared_ptr<ImageSet> imageSet;
+	while(toLoad.Pop(imageSet))
 	{
-		// Extract the one item we should work on uploading right now.
-		shared_ptr<ImageSet> imageSet = toLoad.front();
-		toLoad.pop();
-		
-		// It's now safe to modify the lists.
-		lock.unlock();
-		
 		imageSet->Upload(SpriteSet::Modify(imageSet->Name()));
-		
-		lock.lock();
 		++completed;
+		
+		if(chrono::duration<double>(chrono::steady_clock::now() - start).count() >= timeBudget)
+			break;
 	}
 	
 	// Wait until we have completed loading of as many sprites as we have added.
-	// The value of "added" is protected by readMutex.
-	unique_lock<mutex> readLock(readMutex);
+	int added = this->added;
+	int completed = this->completed;
 	// Special cases: we're bailing out, or we are done.
 	if(added <= 0 || added == completed)
 		return 1.;
 	return static_cast<double>(completed) / static_cast<double>(added);
 }
+
+
+
+// Get the highest priority image set that is waiting to be read, or null
+// if there are none. The read mutex must be locked.
+shared_ptr<ImageSet> SpriteQueue::NextToRead()
+{
+	for(deque<shared_ptr<ImageSet>> &list : toRead)
+		if(!list.empty())
+		{
+			shared_ptr<ImageSet> imageSet = list.front();
+			list.pop_front();
+			waiting.erase(imageSet->Name());
+			return imageSet;
+		}
+	return nullptr;
+}
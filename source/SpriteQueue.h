@@ -13,7 +13,11 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef SPRITE_QUEUE_H_
 #define SPRITE_QUEUE_H_
 
+#include "LockFreeQueue.h"
+
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -32,15 +36,37 @@ class Sprite;
 // Class for queuing up a list of sprites to be loaded from the disk, with a set of
 // worker threads that begins loading them as soon as they are added.
 class SpriteQueue {
+public:
+	// Sprites are read from disk in order of priority, and in the order they
+	// were added within each priority class.
+	enum Priority {
+		// The user interface, so the menus can be drawn.
+		INTERFACE,
+		// Anything in the star system the player is in.
+		SYSTEM,
+		// Ships, outfits, and the effects needed for flight.
+		SHIPS,
+		// Everything else.
+		OTHER,
+		PRIORITY_COUNT
+	};
+	
+	
 public:
 	SpriteQueue();
 	~SpriteQueue();
 	
 	// Add a sprite to load.
-	void Add(const std::shared_ptr<ImageSet> &images);
-	// Unload the texture for the given sprite (to free up memory).
+	void Add(const std::shared_ptr<ImageSet> &images, Priority priority = OTHER);
+	// If the given sprite is still waiting to be read, move it up to the given
+	// priority class (if that is higher than its current one).
+	void Prioritize(const std::string &name, Priority priority);
+	// Unload the texture for the given sprite (to free up memory). This must
+	// only be called from the main thread.
 	void Unload(const std::string &name);
-	// Upload more iamges and find out our percent completion.
+	// Upload more iamges and find out our percent completion. This does not
+	// take any locks, and it stops uploading once it has used up its time
+	// budget for this frame, so it can be called every frame.
 	double Progress();
 	// Finish loading.
 	void Finish();
@@ -50,23 +76,33 @@ public:
 	
 	
 private:
-	double DoLoad(std::unique_lock<std::mutex> &lock);
+	// Upload images until there are none left or the given number of seconds
+	// have passed. At least one image is uploaded if any are ready.
+	double DoLoad(double timeBudget);
+	// Get the highest priority image set that is waiting to be read, or null
+	// if there are none. The read mutex must be locked.
+	std::shared_ptr<ImageSet> NextToRead();
 	
 	
 private:
-	// These are the image sets that need to be loaded from disk.
-	std::queue<std::shared_ptr<ImageSet>> toRead;
+	// These are the image sets that need to be loaded from disk, in a separate
+	// list for each priority class. For each one, remember which class it is in.
+	std::deque<std::shared_ptr<ImageSet>> toRead[PRIORITY_COUNT];
+	std::map<std::string, Priority> waiting;
 	std::mutex readMutex;
 	std::condition_variable readCondition;
-	int added = 0;
+	std::atomic<int> added;
 	
 	// These image sets have been loaded from disk but have not been uplodaed.
-	std::queue<std::shared_ptr<ImageSet>> toLoad;
+	// The worker threads hand them to the main thread without locking. The
+	// mutex and condition are only used by Finish() to wait for more images.
+	LockFreeQueue<std::shared_ptr<ImageSet>> toLoad;
 	std::mutex loadMutex;
 	std::condition_variable loadCondition;
-	int completed = 0;
+	std::atomic<int> completed;
 	
-	// These sprites must be unloaded to reclaim GPU memory.
+	// These sprites must be unloaded to reclaim GPU memory. This is only ever
+	// used by the main thread.
 	std::queue<std::string> toUnload;
 	
 	// Worker threads for loading sprites from disk.
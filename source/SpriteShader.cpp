@@ -16,7 +16,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Screen.h"
 #include "Shader.h"
 #include "Sprite.h"
+#include "StreamBuffer.h"
 
+#include <cstdio>
+#include <string>
 #include <vector>
 
 using namespace std;
@@ -34,7 +37,28 @@ namespace {
 	
 	GLuint vao;
 	GLuint vbo;
-
+	
+	// If the OpenGL version supports instanced drawing, a second version of
+	// the shader takes each sprite's parameters from a vertex buffer instead
+	// of from uniforms, so many sprites can be drawn with one command.
+	bool useInstancing = false;
+	Shader instancedShader;
+	GLint instancedScaleI;
+	GLint instancePositionI;
+	GLint instanceTransformI;
+	GLint instanceBlurI;
+	GLint instanceFrameI;
+	
+	GLuint instancedVao;
+	GLuint instanceVbo;
+	// Each instance has twelve floats: position (2), transform (4), blur (2),
+	// and the frame, frame count, clip, and alpha.
+	const int INSTANCE_FLOATS = 12;
+	const GLsizeiptr INSTANCE_SIZE = INSTANCE_FLOATS * sizeof(float);
+	// The instance data is streamed into the instance VBO.
+	StreamBuffer buffer(1 << 18);
+	vector<float> instanceData;
+	
 	const vector<vector<GLint>> SWIZZLE = {
 		{GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}, // red + yellow markings (republic)
 		{GL_RED, GL_BLUE, GL_GREEN, GL_ALPHA}, // red + magenta markings
@@ -46,6 +70,40 @@ namespace {
 		{GL_BLUE, GL_ZERO, GL_ZERO, GL_ALPHA},  // red only (cloaked)
 		{GL_ZERO, GL_ZERO, GL_ZERO, GL_ALPHA}  // black only (outline)
 	};
+	
+	// Instanced drawing, and the vertex attribute divisors it needs, are part
+	// of OpenGL 3.3 and above.
+	bool HasInstancing()
+	{
+		const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+		int major = 0;
+		int minor = 0;
+		if(!version || sscanf(version, "%d.%d", &major, &minor) != 2)
+			return false;
+		return (major > 3 || (major == 3 && minor >= 3));
+	}
+	
+	// Set the texture and color swizzle for the given item.
+	void BindTexture(const SpriteShader::Item &item)
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, item.texture);
+		
+		// Bounds check for the swizzle value:
+		int swizzle = (static_cast<size_t>(item.swizzle) >= SWIZZLE.size() ? 0 : item.swizzle);
+		// Set the color swizzle.
+		glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, SWIZZLE[swizzle].data());
+	}
+	
+	// Point the per-instance vertex attributes at the given byte offset in the
+	// instance buffer.
+	void SetInstanceOffset(GLsizeiptr offset)
+	{
+		const char *base = reinterpret_cast<const char *>(offset);
+		glVertexAttribPointer(instancePositionI, 2, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, base);
+		glVertexAttribPointer(instanceTransformI, 4, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, base + 2 * sizeof(float));
+		glVertexAttribPointer(instanceBlurI, 2, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, base + 6 * sizeof(float));
+		glVertexAttribPointer(instanceFrameI, 4, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, base + 8 * sizeof(float));
+	}
 }
 
 
@@ -70,12 +128,22 @@ void SpriteShader::Init()
 		"  fragTexCoord = vec2(texCoord.x, max(clip, texCoord.y)) + blurOff;\n"
 		"}\n";
 	
-	static const char *fragmentCode =
-		"uniform sampler2DArray tex;\n"
+	// The fragment shader is the same for both versions of the shader, except
+	// that the instanced version gets the sprite parameters from its inputs.
+	static const char *fragmentUniforms =
 		"uniform float frame;\n"
 		"uniform float frameCount;\n"
 		"uniform vec2 blur;\n"
-		"uniform float alpha;\n"
+		"uniform float alpha;\n";
+	
+	static const char *fragmentInputs =
+		"flat in float frame;\n"
+		"flat in float frameCount;\n"
+		"flat in vec2 blur;\n"
+		"flat in float alpha;\n";
+	
+	static const char *fragmentCode =
+		"uniform sampler2DArray tex;\n"
 		"const int range = 5;\n"
 		
 		"in vec2 fragTexCoord;\n"
@@ -115,7 +183,7 @@ void SpriteShader::Init()
 		"  finalColor = color * alpha;\n"
 		"}\n";
 	
-	shader = Shader(vertexCode, fragmentCode);
+	shader = Shader(vertexCode, (string(fragmentUniforms) + fragmentCode).c_str());
 	scaleI = shader.Uniform("scale");
 	frameI = shader.Uniform("frame");
 	frameCountI = shader.Uniform("frameCount");
@@ -150,6 +218,70 @@ void SpriteShader::Init()
 	// unbind the VBO and VAO
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
+	
+	useInstancing = HasInstancing();
+	if(!useInstancing)
+		return;
+	
+	static const char *instancedVertexCode =
+		"uniform vec2 scale;\n"
+		
+		"in vec2 vert;\n"
+		"in vec2 instancePosition;\n"
+		"in vec4 instanceTransform;\n"
+		"in vec2 instanceBlur;\n"
+		"in vec4 instanceFrame;\n"
+		
+		"out vec2 fragTexCoord;\n"
+		"flat out float frame;\n"
+		"flat out float frameCount;\n"
+		"flat out vec2 blur;\n"
+		"flat out float alpha;\n"
+		
+		"void main() {\n"
+		"  frame = instanceFrame.x;\n"
+		"  frameCount = instanceFrame.y;\n"
+		"  float clip = instanceFrame.z;\n"
+		"  alpha = instanceFrame.w;\n"
+		"  blur = instanceBlur;\n"
+		"  mat2 transform = mat2(instanceTransform);\n"
+		"  vec2 blurOff = 2 * vec2(vert.x * abs(blur.x), vert.y * abs(blur.y));\n"
+		"  gl_Position = vec4((transform * (vert + blurOff) + instancePosition) * scale, 0, 1);\n"
+		"  vec2 texCoord = vert + vec2(.5, .5);\n"
+		"  fragTexCoord = vec2(texCoord.x, max(clip, texCoord.y)) + blurOff;\n"
+		"}\n";
+	
+	instancedShader = Shader(instancedVertexCode, (string(fragmentInputs) + fragmentCode).c_str());
+	instancedScaleI = instancedShader.Uniform("scale");
+	instancePositionI = instancedShader.Attrib("instancePosition");
+	instanceTransformI = instancedShader.Attrib("instanceTransform");
+	instanceBlurI = instancedShader.Attrib("instanceBlur");
+	instanceFrameI = instancedShader.Attrib("instanceFrame");
+	
+	glUseProgram(instancedShader.Object());
+	glUniform1i(instancedShader.Uniform("tex"), 0);
+	glUseProgram(0);
+	
+	// The instanced VAO uses the same quad vertices, plus the instance data,
+	// which advances once per sprite instead of once per vertex.
+	glGenVertexArrays(1, &instancedVao);
+	glBindVertexArray(instancedVao);
+	
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glEnableVertexAttribArray(instancedShader.Attrib("vert"));
+	glVertexAttribPointer(instancedShader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+	
+	glGenBuffers(1, &instanceVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+	for(GLint attrib : {instancePositionI, instanceTransformI, instanceBlurI, instanceFrameI})
+	{
+		glEnableVertexAttribArray(attrib);
+		glVertexAttribDivisor(attrib, 1);
+	}
+	SetInstanceOffset(0);
+	
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
 }
 
 
@@ -181,19 +313,74 @@ void SpriteShader::Draw(const Sprite *sprite, const Point &position, float zoom,
 
 void SpriteShader::Bind()
 {
-	glUseProgram(shader.Object());
-	glBindVertexArray(vao);
-	
 	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
-	glUniform2fv(scaleI, 1, scale);
+	if(useInstancing)
+	{
+		glUseProgram(instancedShader.Object());
+		glBindVertexArray(instancedVao);
+		// Bind the instance buffer so we can upload data to it.
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+		glUniform2fv(instancedScaleI, 1, scale);
+	}
+	else
+	{
+		glUseProgram(shader.Object());
+		glBindVertexArray(vao);
+		glUniform2fv(scaleI, 1, scale);
+	}
 }
 
 
 
 void SpriteShader::Add(const Item &item, bool withBlur)
 {
-	glBindTexture(GL_TEXTURE_2D_ARRAY, item.texture);
+	Add(&item, 1, withBlur);
+}
+
+
 
+// Draw the given number of items, which must all have the same texture and
+// swizzle. If possible, they are all drawn with a single command.
+void SpriteShader::Add(const Item *items, size_t count, bool withBlur)
+{
+	if(!count)
+		return;
+	
+	if(!useInstancing)
+	{
+		for(size_t i = 0; i < count; ++i)
+			AddUniforms(items[i], withBlur);
+		return;
+	}
+	
+	BindTexture(items[0]);
+	
+	// Gather the parameters of all the sprites.
+	instanceData.clear();
+	for(size_t i = 0; i < count; ++i)
+	{
+		const Item &item = items[i];
+		const float instance[INSTANCE_FLOATS] = {
+			item.position[0], item.position[1],
+			item.transform[0], item.transform[1], item.transform[2], item.transform[3],
+			withBlur ? item.blur[0] : 0.f, withBlur ? item.blur[1] : 0.f,
+			// Clipping has the opposite sense in the shader.
+			item.frame, item.frameCount, 1.f - item.clip, item.alpha};
+		instanceData.insert(instanceData.end(), instance, instance + INSTANCE_FLOATS);
+	}
+	
+	// Upload the instance data and draw all the instances.
+	GLsizeiptr offset = buffer.Upload(instanceData.data(), INSTANCE_SIZE * count);
+	SetInstanceOffset(offset);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+}
+
+
+
+void SpriteShader::AddUniforms(const Item &item, bool withBlur)
+{
+	BindTexture(item);
+	
 	glUniform1f(frameI, item.frame);
 	glUniform1f(frameCountI, item.frameCount);
 	glUniform2fv(positionI, 1, item.position);
@@ -205,11 +392,6 @@ void SpriteShader::Add(const Item &item, bool withBlur)
 	glUniform1f(clipI, 1.f - item.clip);
 	glUniform1f(alphaI, item.alpha);
 	
-	// Bounds check for the swizzle value:
-	int swizzle = (static_cast<size_t>(item.swizzle) >= SWIZZLE.size() ? 0 : item.swizzle);
-	// Set the color swizzle.
-	glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, SWIZZLE[swizzle].data());
-	
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
@@ -217,6 +399,8 @@ void SpriteShader::Add(const Item &item, bool withBlur)
 
 void SpriteShader::Unbind()
 {
+	if(useInstancing)
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 	glUseProgram(0);
 	
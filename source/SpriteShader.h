@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 class Sprite;
 class Point;
 
+#include <cstddef>
 #include <cstdint>
 
 
@@ -50,7 +51,15 @@ public:
 	
 	static void Bind();
 	static void Add(const Item &item, bool withBlur = false);
+	// Draw the given number of items, which must all have the same texture and
+	// swizzle. If possible, they are all drawn with a single command.
+	static void Add(const Item *items, size_t count, bool withBlur = false);
 	static void Unbind();
+	
+	
+private:
+	// Draw a single item, passing its parameters as uniforms.
+	static void AddUniforms(const Item &item, bool withBlur);
 };
 
 
@@ -0,0 +1,69 @@
+/* StreamBuffer.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "StreamBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+
+
+StreamBuffer::StreamBuffer(GLsizeiptr minSize)
+	: minSize(minSize)
+{
+}
+
+
+
+// Forget the size of the buffer, e.g. because a new buffer object is bound
+// to it. Its storage will be allocated by the next upload.
+void StreamBuffer::Reset()
+{
+	bufferSize = 0;
+	bufferUsed = 0;
+}
+
+
+
+// Copy the given data into the buffer that is bound to GL_ARRAY_BUFFER, and
+// return the byte offset in the buffer where it was written.
+GLsizeiptr StreamBuffer::Upload(const void *data, GLsizeiptr size)
+{
+	// If there is no room left in the buffer, orphan it, growing it if this
+	// data would not fit even in an empty buffer.
+	if(bufferUsed + size > bufferSize)
+	{
+		bufferSize = max(bufferSize, minSize);
+		while(bufferSize < size)
+			bufferSize *= 2;
+		glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+		bufferUsed = 0;
+	}
+	
+	// Upload the data into the unused part of the buffer. No draw command uses
+	// that part of the buffer, so there is no need to wait.
+	void *target = glMapBufferRange(GL_ARRAY_BUFFER, bufferUsed, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if(target)
+	{
+		memcpy(target, data, size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	else
+		glBufferSubData(GL_ARRAY_BUFFER, bufferUsed, size, data);
+	
+	GLsizeiptr offset = bufferUsed;
+	bufferUsed += size;
+	return offset;
+}
@@ -0,0 +1,46 @@
+/* StreamBuffer.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef STREAM_BUFFER_H_
+#define STREAM_BUFFER_H_
+
+#include "gl_header.h"
+
+
+
+// Class for uploading new vertex data to a buffer every frame. The buffer is
+// filled like a ring: each upload is written after the previous one, even from
+// one frame to the next, so the GPU never has to finish drawing before new data
+// can be written. Once the buffer is full, its storage is "orphaned" and the
+// driver hands over a fresh block of memory, keeping the old one alive until
+// the draws that use it are done.
+class StreamBuffer {
+public:
+	explicit StreamBuffer(GLsizeiptr minSize);
+	
+	// Forget the size of the buffer, e.g. because a new buffer object is bound
+	// to it. Its storage will be allocated by the next upload.
+	void Reset();
+	// Copy the given data into the buffer that is bound to GL_ARRAY_BUFFER, and
+	// return the byte offset in the buffer where it was written.
+	GLsizeiptr Upload(const void *data, GLsizeiptr size);
+	
+	
+private:
+	GLsizeiptr minSize;
+	GLsizeiptr bufferSize = 0;
+	GLsizeiptr bufferUsed = 0;
+};
+
+
+
+#endif
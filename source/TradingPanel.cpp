@@ -61,6 +61,7 @@ TradingPanel::TradingPanel(PlayerInfo &player)
 	: player(player), system(*player.GetSystem()), COMMODITY_COUNT(GameData::Commodities().size())
 {
 	SetTrapAllEvents(false);
+	SetIsStatic(true);
 }
 
 
@@ -26,7 +26,7 @@ using namespace std;
 
 // Default constructor.
 UI::UI()
-	: isDone(false)
+	: isDone(false), isDirty(true)
 {
 }
 
@@ -125,8 +125,45 @@ void UI::DrawAll()
 		if((*--it)->IsFullScreen())
 			break;
 	
+	// A panel may mark itself dirty again while drawing (e.g. if it is in the
+	// middle of an animation), so clear the flag before drawing it.
 	for( ; it != stack.end(); ++it)
+	{
+		(*it)->isDirty = false;
 		(*it)->Draw();
+	}
+	isDirty = false;
+}
+
+
+
+// Check whether anything has changed since the panels were last drawn. If
+// not, drawing them again would just produce the same frame.
+bool UI::IsDirty() const
+{
+	if(isDirty || !toPush.empty() || !toPop.empty())
+		return true;
+	
+	// Only the panels that are actually drawn matter.
+	vector<shared_ptr<Panel>>::const_iterator it = stack.end();
+	while(it != stack.begin())
+		if((*--it)->IsFullScreen())
+			break;
+	
+	for( ; it != stack.end(); ++it)
+		if((*it)->NeedsRedraw())
+			return true;
+	
+	return false;
+}
+
+
+
+// Make sure the panels are drawn again on the next frame, e.g. because the
+// window was resized or uncovered.
+void UI::SetDirty()
+{
+	isDirty = true;
 }
 
 
@@ -189,6 +226,7 @@ void UI::Reset()
 	toPush.clear();
 	toPop.clear();
 	isDone = false;
+	isDirty = true;
 }
 
 
@@ -247,6 +285,9 @@ Point UI::GetMouse()
 // If a push or pop is queued, apply it.
 void UI::PushOrPop()
 {
+	if(!toPush.empty() || !toPop.empty())
+		isDirty = true;
+	
 	// Handle any panels that should be added.
 	for(shared_ptr<Panel> &panel : toPush)
 		if(panel)
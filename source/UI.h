@@ -41,6 +41,12 @@ public:
 	void StepAll();
 	// Draw all the panels.
 	void DrawAll();
+	// Check whether anything has changed since the panels were last drawn. If
+	// not, drawing them again would just produce the same frame.
+	bool IsDirty() const;
+	// Make sure the panels are drawn again on the next frame, e.g. because the
+	// window was resized or uncovered.
+	void SetDirty();
 	
 	// Add the given panel to the stack. If you do not want a panel to be
 	// deleted when it is popped, save a copy of its shared pointer elsewhere.
@@ -82,6 +88,7 @@ private:
 	std::vector<std::shared_ptr<Panel>> stack;
 	
 	bool isDone;
+	bool isDirty;
 	std::vector<std::shared_ptr<Panel>> toPush;
 	std::vector<const Panel *> toPop;
 };
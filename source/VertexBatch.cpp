@@ -0,0 +1,123 @@
+/* VertexBatch.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "VertexBatch.h"
+
+#include "Point.h"
+#include "Screen.h"
+#include "Shader.h"
+
+using namespace std;
+
+
+
+VertexBatch::VertexBatch(const VertexBatch &other)
+	: data(other.data), isDirty(true)
+{
+}
+
+
+
+VertexBatch &VertexBatch::operator=(const VertexBatch &other)
+{
+	data = other.data;
+	isDirty = true;
+	return *this;
+}
+
+
+
+VertexBatch::~VertexBatch()
+{
+	if(vao)
+	{
+		glDeleteBuffers(1, &vbo);
+		glDeleteVertexArrays(1, &vao);
+	}
+}
+
+
+
+void VertexBatch::Clear()
+{
+	data.clear();
+	isDirty = true;
+}
+
+
+
+// Add one vertex, made up of the given number of floats.
+void VertexBatch::Add(const float *vertex, int size)
+{
+	data.insert(data.end(), vertex, vertex + size);
+	isDirty = true;
+}
+
+
+
+// Draw the vertices as triangles, using the given shader. The layout says
+// which attributes each vertex contains, in order.
+void VertexBatch::Draw(const Shader &shader, const vector<Attribute> &layout, const Point &center, double zoom) const
+{
+	if(data.empty())
+		return;
+	
+	int vertexFloats = 0;
+	for(const Attribute &attribute : layout)
+		vertexFloats += attribute.size;
+	
+	if(!vao)
+	{
+		glGenVertexArrays(1, &vao);
+		glBindVertexArray(vao);
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		
+		const GLsizei stride = vertexFloats * sizeof(GLfloat);
+		size_t offset = 0;
+		for(const Attribute &attribute : layout)
+		{
+			GLint attrib = shader.Attrib(attribute.name);
+			glEnableVertexAttribArray(attrib);
+			glVertexAttribPointer(attrib, attribute.size, GL_FLOAT, GL_FALSE, stride,
+				reinterpret_cast<const GLvoid *>(offset * sizeof(GLfloat)));
+			offset += attribute.size;
+		}
+		scaleI = shader.Uniform("scale");
+		centerI = shader.Uniform("center");
+		zoomI = shader.Uniform("zoom");
+	}
+	else
+	{
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	}
+	// The vertices only need to be uploaded again if they have changed.
+	if(isDirty)
+	{
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * data.size(), data.data(), GL_STATIC_DRAW);
+		isDirty = false;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	
+	glUseProgram(shader.Object());
+	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
+	glUniform2fv(scaleI, 1, scale);
+	GLfloat position[2] = {static_cast<float>(center.X()), static_cast<float>(center.Y())};
+	glUniform2fv(centerI, 1, position);
+	glUniform1f(zoomI, zoom);
+	
+	glDrawArrays(GL_TRIANGLES, 0, data.size() / vertexFloats);
+	
+	glBindVertexArray(0);
+	glUseProgram(0);
+}
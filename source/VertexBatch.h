@@ -0,0 +1,67 @@
+/* VertexBatch.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef VERTEX_BATCH_H_
+#define VERTEX_BATCH_H_
+
+#include <cstdint>
+#include <vector>
+
+class Point;
+class Shader;
+
+
+
+// Class holding the vertices of a set of shapes that are all drawn with a
+// single command. The vertices are kept in a vertex buffer, which is only
+// uploaded again when they change. The shader that draws them must have
+// "scale", "center", and "zoom" uniforms, so the batch can be drawn with any
+// map position at the center of the screen and any zoom factor. Copying a
+// batch copies its vertices, but not its OpenGL buffers.
+class VertexBatch {
+public:
+	// The name of a vertex attribute in the shader, and how many floats it has.
+	struct Attribute {
+		const char *name;
+		int size;
+	};
+	
+	
+public:
+	VertexBatch() = default;
+	VertexBatch(const VertexBatch &other);
+	VertexBatch &operator=(const VertexBatch &other);
+	~VertexBatch();
+	
+	void Clear();
+	// Add one vertex, made up of the given number of floats.
+	void Add(const float *vertex, int size);
+	// Draw the vertices as triangles, using the given shader. The layout says
+	// which attributes each vertex contains, in order.
+	void Draw(const Shader &shader, const std::vector<Attribute> &layout, const Point &center, double zoom) const;
+	
+	
+private:
+	std::vector<float> data;
+	mutable uint32_t vao = 0;
+	mutable uint32_t vbo = 0;
+	mutable bool isDirty = false;
+	// The locations of the shader's uniforms are looked up along with the
+	// vertex attributes, when the vertex array is first set up.
+	mutable int scaleI = 0;
+	mutable int centerI = 0;
+	mutable int zoomI = 0;
+};
+
+
+
+#endif
@@ -16,14 +16,68 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Point.h"
 
 #include <cstring>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 
 using namespace std;
 
+namespace {
+	// Everything that affects how a string is wrapped.
+	class LayoutKey {
+	public:
+		bool operator==(const LayoutKey &other) const;
+	
+	public:
+		string text;
+		const Font *font;
+		int wrapWidth;
+		int tabWidth;
+		int lineHeight;
+		int paragraphBreak;
+		int alignment;
+	};
+	
+	bool LayoutKey::operator==(const LayoutKey &other) const
+	{
+		return font == other.font && wrapWidth == other.wrapWidth && tabWidth == other.tabWidth
+			&& lineHeight == other.lineHeight && paragraphBreak == other.paragraphBreak
+			&& alignment == other.alignment && text == other.text;
+	}
+	
+	class LayoutHash {
+	public:
+		size_t operator()(const LayoutKey &key) const
+		{
+			size_t hash = std::hash<string>()(key.text);
+			for(int value : {key.wrapWidth, key.tabWidth, key.lineHeight, key.paragraphBreak, key.alignment})
+				hash = hash * 31 + value;
+			return hash ^ std::hash<const Font *>()(key.font);
+		}
+	};
+	
+	// If this many different layouts are cached, forget them and start over,
+	// so text that changes all the time (e.g. messages) does not fill memory.
+	const size_t MAX_LAYOUTS = 1024;
+}
+
+
+
+// The result of wrapping a particular string with particular settings. The
+// text is stored with a '\0' after each word, so each word can be drawn as a
+// separate string.
+class WrappedText::Layout {
+public:
+	string text;
+	vector<Word> words;
+	int height = 0;
+};
+
 
 
 WrappedText::WrappedText()
 	: font(nullptr), space(0), wrapWidth(1000), tabWidth(0),
-	  lineHeight(0), paragraphBreak(0), alignment(JUSTIFIED), height(0)
+	  lineHeight(0), paragraphBreak(0), alignment(JUSTIFIED)
 {
 }
 
@@ -131,18 +185,14 @@ void WrappedText::SetParagraphBreak(int height)
 // always begin at (0, 0).
 void WrappedText::Wrap(const string &str)
 {
-	SetText(str.data(), str.length());
-	
-	Wrap();
+	Wrap(str.data(), str.length());
 }
 
 
 
 void WrappedText::Wrap(const char *str)
 {
-	SetText(str, strlen(str));
-	
-	Wrap();
+	Wrap(str, strlen(str));
 }
 
 
@@ -150,7 +200,7 @@ void WrappedText::Wrap(const char *str)
 // Get the height of the wrapped text.
 int WrappedText::Height() const
 {
-	return height;
+	return layout ? layout->height : 0;
 }
 
 
@@ -158,8 +208,11 @@ int WrappedText::Height() const
 // Draw the text.
 void WrappedText::Draw(const Point &topLeft, const Color &color) const
 {
-	for(const Word &w : words)
-		font->Draw(text.c_str() + w.Index(), w.Pos() + topLeft, color);
+	if(!layout)
+		return;
+	
+	for(const Word &w : layout->words)
+		font->Draw(layout->text.c_str() + w.Index(), w.Pos() + topLeft, color);
 }
 
 
@@ -185,21 +238,40 @@ Point WrappedText::Word::Pos() const
 
 
 
-void WrappedText::SetText(const char *it, size_t length)
+// Find the layout of the given text with the current settings, wrapping it
+// only if it has not been wrapped that way before.
+void WrappedText::Wrap(const char *str, size_t length)
 {
-	// Clear any previous word-wrapping data. It becomes invalid as soon as the
-	// underlying text buffer changes.
-	words.clear();
+	// Layouts are shared by every WrappedText, because the same text is often
+	// wrapped by objects that only exist while something is being drawn.
+	static mutex cacheMutex;
+	static unordered_map<LayoutKey, shared_ptr<const Layout>, LayoutHash> cache;
+	
+	LayoutKey key{string(str, length), font, wrapWidth, tabWidth, lineHeight, paragraphBreak, alignment};
+	lock_guard<mutex> lock(cacheMutex);
+	auto it = cache.find(key);
+	if(it != cache.end())
+	{
+		layout = it->second;
+		return;
+	}
 	
-	// Reallocate that buffer.
-	text.assign(it, length);
+	if(cache.size() >= MAX_LAYOUTS)
+		cache.clear();
+	shared_ptr<Layout> result(new Layout);
+	result->text = key.text;
+	Wrap(*result);
+	layout = result;
+	cache.emplace(std::move(key), std::move(result));
 }
 
 
 
-void WrappedText::Wrap()
+void WrappedText::Wrap(Layout &layout) const
 {
-	height = 0;
+	string &text = layout.text;
+	vector<Word> &words = layout.words;
+	layout.height = 0;
 	if(text.empty() || !font)
 		return;
 	
@@ -237,7 +309,7 @@ void WrappedText::Wrap()
 				word.x = 0;
 				
 				// Adjust the spacing of words in the now-complete line.
-				AdjustLine(lineBegin, lineWidth, false);
+				AdjustLine(words, lineBegin, lineWidth, false);
 			}
 			// Store this word, then advance the x position to the end of it.
 			words.push_back(word);
@@ -256,7 +328,7 @@ void WrappedText::Wrap()
 			word.x = 0;
 			
 			// Adjust the word spacings on the now-completed line.
-			AdjustLine(lineBegin, lineWidth, true);
+			AdjustLine(words, lineBegin, lineWidth, true);
 		}
 		// Otherwise, whitespace just adds to the x position.
 		else if(c <= ' ')
@@ -280,7 +352,7 @@ void WrappedText::Wrap()
 			word.x = 0;
 			
 			// Adjust the spacing of words in the now-complete line.
-			AdjustLine(lineBegin, lineWidth, false);
+			AdjustLine(words, lineBegin, lineWidth, false);
 		}
 		// Add this final word to the existing words.
 		words.push_back(word);
@@ -290,14 +362,14 @@ void WrappedText::Wrap()
 		lineWidth = word.x;
 	}
 	// Adjust the spacing of words in the final line of text.
-	AdjustLine(lineBegin, lineWidth, true);
+	AdjustLine(words, lineBegin, lineWidth, true);
 	
-	height = word.y;
+	layout.height = word.y;
 }
 
 
 
-void WrappedText::AdjustLine(unsigned &lineBegin, int &lineWidth, bool isEnd)
+void WrappedText::AdjustLine(vector<Word> &words, unsigned &lineBegin, int &lineWidth, bool isEnd) const
 {
 	int wordCount = words.size() - lineBegin;
 	int extraSpace = wrapWidth - lineWidth;
@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Point.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,7 +25,9 @@ class Font;
 
 
 // Class for calculating word positions in wrapped text. You can specify various
-// parameters of the formatting, including text alignment.
+// parameters of the formatting, including text alignment. The results are
+// cached and shared, so wrapping text that was already wrapped with the same
+// settings (e.g. every time a panel is drawn) does not measure it again.
 class WrappedText {
 public:
 	WrappedText();
@@ -67,13 +70,6 @@ public:
 	void Draw(const Point &topLeft, const Color &color) const;
 	
 	
-private:
-	void SetText(const char *it, size_t length);
-	void Wrap();
-	void AdjustLine(unsigned &lineBegin, int &lineWidth, bool isEnd);
-	int Space(char c) const;
-	
-	
 private:
 	// The returned text is a series of words and (x, y) positions:
 	class Word {
@@ -90,6 +86,15 @@ private:
 		
 		friend class WrappedText;
 	};
+	// The result of wrapping a particular string with particular settings.
+	class Layout;
+	
+	
+private:
+	void Wrap(const char *str, size_t length);
+	void Wrap(Layout &layout) const;
+	void AdjustLine(std::vector<Word> &words, unsigned &lineBegin, int &lineWidth, bool isEnd) const;
+	int Space(char c) const;
 	
 	
 private:
@@ -102,9 +107,7 @@ private:
 	int paragraphBreak;
 	Align alignment;
 	
-	std::string text;
-	std::vector<Word> words;
-	int height;
+	std::shared_ptr<const Layout> layout;
 };
 
 
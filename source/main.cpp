@@ -51,6 +51,7 @@ using namespace std;
 
 void PrintHelp();
 void PrintVersion();
+void PrintAudioStatistics();
 void SetIcon(SDL_Window *window);
 void AdjustViewport(SDL_Window *window);
 int DoError(string message, SDL_Window *window = nullptr, SDL_GLContext context = nullptr);
@@ -63,6 +64,7 @@ int main(int argc, char *argv[])
 {
 	Conversation conversation;
 	bool debugMode = false;
+	bool useNullAudio = false;
 	for(const char *const *it = argv + 1; *it; ++it)
 	{
 		string arg = *it;
@@ -80,6 +82,8 @@ int main(int argc, char *argv[])
 			conversation = LoadConversation();
 		else if(arg == "-d" || arg == "--debug")
 			debugMode = true;
+		else if(arg == "--null-audio")
+			useNullAudio = true;
 	}
 	PlayerInfo player;
 	
@@ -88,7 +92,9 @@ int main(int argc, char *argv[])
 		
 		// Begin loading the game data.
 		GameData::BeginLoad(argv);
-		Audio::Init(GameData::Sources());
+		Audio::Init(GameData::Sources(), useNullAudio);
+		if(debugMode)
+			GameData::WatchData();
 		
 		// On Windows, make sure that the sleep timer has at least 1 ms resolution
 		// to avoid irregular frame rates.
@@ -97,6 +103,8 @@ int main(int argc, char *argv[])
 #endif
 		
 		player.LoadRecent();
+		// Load the sprites in the player's current system before the rest.
+		GameData::Prioritize(player.GetSystem());
 		
 		// Check how big the window can be.
 		SDL_DisplayMode mode;
@@ -231,13 +239,29 @@ int main(int argc, char *argv[])
 		bool isPaused = false;
 		// If fast forwarding, keep track of whether the current frame should be drawn.
 		int skipFrame = 0;
+		// When idle, still run the game loop this often (in milliseconds). The
+		// music runs dry after about a second if Audio::Step() is not called.
+		const int IDLE_TIMEOUT = 100;
+		// Remember which set of panels was drawn on the last frame, so that if
+		// the menu is closed the game panels are drawn again.
+		const UI *drawnPanels = nullptr;
 		while(!menuPanels.IsDone())
 		{
+			// If nothing on the screen can change until the player does something,
+			// wait for the next event instead of drawing the same frame again. Wake
+			// up now and then anyway, so the music keeps playing.
+			UI &idlePanels = (menuPanels.IsEmpty() ? gamePanels : menuPanels);
+			if(&idlePanels == drawnPanels && !idlePanels.IsDirty())
+				SDL_WaitEventTimeout(nullptr, IDLE_TIMEOUT);
+			
 			// Handle any events that occurred in this frame.
 			SDL_Event event;
 			while(SDL_PollEvent(&event))
 			{
 				UI &activeUI = (menuPanels.IsEmpty() ? gamePanels : menuPanels);
+				// Any event may change what should be shown on the screen,
+				// including ones that are handled here rather than by a panel.
+				activeUI.SetDirty();
 				
 				// If the mouse moves, reset the cursor movement timeout.
 				if(event.type == SDL_MOUSEMOTION)
@@ -249,6 +273,10 @@ int main(int argc, char *argv[])
 				{
 					isPaused = !isPaused;
 				}
+				// In debug mode, F5 reloads any data files that have changed. The
+				// main panel does that once the Engine has stopped calculating.
+				else if(debugMode && event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F5)
+					GameData::RequestReload();
 				else if(event.type == SDL_KEYDOWN && menuPanels.IsEmpty()
 						&& Command(event.key.keysym.sym).Has(Command::MENU)
 						&& !gamePanels.IsEmpty() && gamePanels.Top()->IsInterruptible())
@@ -335,11 +363,19 @@ int main(int argc, char *argv[])
 			Audio::Step();
 			// Events in this frame may have cleared out the menu, in which case
 			// we should draw the game panels instead:
-			(menuPanels.IsEmpty() ? gamePanels : menuPanels).DrawAll();
-			if(fastForward)
-				SpriteShader::Draw(SpriteSet::Get("ui/fast forward"), Screen::TopLeft() + Point(10., 10.));
-			
-			SDL_GL_SwapWindow(window);
+			UI &drawUI = (menuPanels.IsEmpty() ? gamePanels : menuPanels);
+			if(&drawUI != drawnPanels || drawUI.IsDirty() || fastForward)
+			{
+				drawUI.DrawAll();
+				drawnPanels = &drawUI;
+				if(fastForward)
+					SpriteShader::Draw(SpriteSet::Get("ui/fast forward"), Screen::TopLeft() + Point(10., 10.));
+				// If any sprites were uploaded, the next frame must show them.
+				if(GameData::UpdateLazySprites())
+					drawUI.SetDirty();
+				
+				SDL_GL_SwapWindow(window);
+			}
 			timer.Wait();
 		}
 		
@@ -356,6 +392,8 @@ int main(int argc, char *argv[])
 		Screen::SetRaw(windowWidth, windowHeight);
 		Preferences::Save();
 		
+		if(useNullAudio)
+			PrintAudioStatistics();
 		Cleanup(window, context);
 	}
 	catch(const runtime_error &error)
@@ -379,7 +417,15 @@ void PrintHelp()
 	cerr << "    -t, --talk: read and display a conversation from STDIN." << endl;
 	cerr << "    -r, --resources <path>: load resources from given directory." << endl;
 	cerr << "    -c, --config <path>: save user's files to given directory." << endl;
-	cerr << "    -d, --debug: turn on debugging features (e.g. caps lock slow motion)." << endl;
+	cerr << "    -d, --debug: turn on debugging features (e.g. caps lock slow motion, F5 to" << endl;
+	cerr << "        reload data files that have changed)." << endl;
+	cerr << "    --profile-load: print how long each part of loading the game data took." << endl;
+	cerr << "    --lazy-sprites <list>: only load the sprites in the given comma-separated" << endl;
+	cerr << "        image directories (e.g. \"outfit,scene\") when they are needed." << endl;
+	cerr << "    --texture-budget <MB>: memory to allow for sprites that are loaded when" << endl;
+	cerr << "        needed (landscapes and --lazy-sprites) before unloading unused ones." << endl;
+	cerr << "    --null-audio: do not use the sound device, but keep track of all the sounds" << endl;
+	cerr << "        that would be played, and print statistics about them on exit." << endl;
 	cerr << endl;
 	cerr << "Report bugs to: mzahniser@gmail.com" << endl;
 	cerr << "Home page: <https://endless-sky.github.io>" << endl;
@@ -400,6 +446,23 @@ void PrintVersion()
 
 
 
+// Print how much work the audio system did, e.g. when benchmarking with the
+// null audio backend.
+void PrintAudioStatistics()
+{
+	Audio::Statistics statistics = Audio::GetStatistics();
+	cerr << endl << "Audio statistics:" << endl;
+	cerr << "Sounds requested: " << statistics.requested << endl;
+	cerr << "Sounds played: " << statistics.played << endl;
+	cerr << "Sounds culled: " << statistics.culled << endl;
+	cerr << "Sounds cut off: " << statistics.stolen << endl;
+	cerr << "Sources allocated: " << statistics.sourcesAllocated << endl;
+	cerr << "Music chunks decoded: " << statistics.musicChunks << endl;
+	cerr << endl;
+}
+
+
+
 void SetIcon(SDL_Window *window)
 {
 	// Load the icon file.